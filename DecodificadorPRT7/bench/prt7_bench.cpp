@@ -0,0 +1,348 @@
+/**
+ * @file prt7_bench.cpp
+ * @brief Microbenchmarks del camino crítico del decodificador PRT-7
+ * @details Mide parsearTrama, RotorDeMapeo::rotar, RotorDeMapeo::getMapeo
+ *          (frente a RotorFijo),
+ *          ListaDeCarga::insertarAlFinal y la decodificación completa sobre
+ *          flujos sintéticos de tramas. Reporta ns/trama, tramas/s y
+ *          reservas de memoria por trama.
+ */
+
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <new>
+
+#include "Argumentos.h"
+#include "TramaBase.h"
+#include "ListaDeCarga.h"
+#include "RotorDeMapeo.h"
+#include "RotorFijo.h"
+#include "ParserTramas.h"
+#include "ArenaTramas.h"
+#include "DecodificadorLote.h"
+#include "DecodificadorSIMD.h"
+
+// ============ CONTEO DE RESERVAS ============
+
+// GCC no reconoce que estos operator delete liberan lo que reservan los new
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+    #pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+/// Número de llamadas a operator new desde el inicio del programa
+static unsigned long long reservas = 0;
+
+void* operator new(size_t bytes) {
+    reservas++;
+    void* p = malloc(bytes ? bytes : 1);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t bytes) {
+    reservas++;
+    void* p = malloc(bytes ? bytes : 1);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// ============ FLUJO SINTÉTICO ============
+
+/// Longitud máxima de una línea sintética ("M,-2147483648" + '\0')
+#define LONGITUD_LINEA 16
+
+/**
+ * @struct FlujoSintetico
+ * @brief Tramas generadas en forma de texto y en forma compacta
+ */
+struct FlujoSintetico {
+    size_t n;               ///< Número de tramas
+    char* lineas;           ///< n líneas de LONGITUD_LINEA bytes
+    int* longitudes;        ///< Longitud de cada línea
+    TramaCompacta* tramas;  ///< Las mismas tramas ya analizadas
+};
+
+/**
+ * @brief Genera un flujo de tramas LOAD/MAP pseudoaleatorio
+ * @param flujo Flujo a llenar
+ * @param n Número de tramas
+ * @param porcentajeMap Porcentaje de tramas MAP (0-100)
+ * @param semilla Semilla del generador
+ */
+static void generarFlujo(FlujoSintetico& flujo, size_t n, int porcentajeMap, unsigned semilla) {
+    const char alfabeto[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ ";
+    srand(semilla);
+
+    flujo.n = n;
+    flujo.lineas = new char[n * LONGITUD_LINEA];
+    flujo.longitudes = new int[n];
+    flujo.tramas = new TramaCompacta[n];
+
+    for (size_t i = 0; i < n; i++) {
+        char* linea = flujo.lineas + i * LONGITUD_LINEA;
+        if (rand() % 100 < porcentajeMap) {
+            int rotacion = rand() % 53 - 26;
+            flujo.longitudes[i] = snprintf(linea, LONGITUD_LINEA, "M,%d", rotacion);
+            flujo.tramas[i] = crearTramaMap(rotacion);
+        } else {
+            char c = alfabeto[rand() % 27];
+            flujo.longitudes[i] = snprintf(linea, LONGITUD_LINEA, "L,%c", c);
+            flujo.tramas[i] = crearTramaLoad(c);
+        }
+    }
+}
+
+/**
+ * @brief Libera la memoria de un flujo sintético
+ */
+static void liberarFlujo(FlujoSintetico& flujo) {
+    delete[] flujo.lineas;
+    delete[] flujo.longitudes;
+    delete[] flujo.tramas;
+}
+
+// ============ MEDICIÓN ============
+
+/// Evita que el compilador elimine el trabajo medido
+static volatile unsigned long long sumidero = 0;
+
+typedef std::chrono::steady_clock Reloj;
+
+/**
+ * @struct Medicion
+ * @brief Estado de una medición en curso
+ */
+struct Medicion {
+    Reloj::time_point inicio;  ///< Momento de inicio
+    unsigned long long reservasInicio; ///< Reservas al iniciar
+};
+
+static Medicion iniciarMedicion() {
+    Medicion m;
+    m.reservasInicio = reservas;
+    m.inicio = Reloj::now();
+    return m;
+}
+
+/**
+ * @brief Termina una medición e imprime su fila de resultados
+ * @param m Medición iniciada con iniciarMedicion
+ * @param nombre Nombre del benchmark
+ * @param operaciones Número de tramas u operaciones medidas
+ */
+static void reportar(const Medicion& m, const char* nombre, size_t operaciones) {
+    Reloj::time_point fin = Reloj::now();
+    unsigned long long nuevas = reservas - m.reservasInicio;
+    double ns = std::chrono::duration<double, std::nano>(fin - m.inicio).count();
+
+    double nsPorOp = operaciones ? ns / operaciones : 0.0;
+    double opsPorSeg = ns > 0 ? operaciones * 1e9 / ns : 0.0;
+    double reservasPorOp = operaciones ? (double)nuevas / operaciones : 0.0;
+
+    printf("%-34s %10.2f %14.0f %12.4f %12llu\n",
+           nombre, nsPorOp, opsPorSeg, reservasPorOp, nuevas);
+}
+
+// ============ BENCHMARKS ============
+
+static void benchParsearHeap(const FlujoSintetico& f) {
+    Medicion m = iniciarMedicion();
+    for (size_t i = 0; i < f.n; i++) {
+        TramaBase* t = parsearTrama(f.lineas + i * LONGITUD_LINEA);
+        sumidero += (t != nullptr);
+        delete t;
+    }
+    reportar(m, "parsearTrama (new/delete)", f.n);
+}
+
+static void benchParsearArena(const FlujoSintetico& f) {
+    ArenaTramas arena;
+    Medicion m = iniciarMedicion();
+    for (size_t i = 0; i < f.n; i++) {
+        TramaBase* t = parsearTrama(f.lineas + i * LONGITUD_LINEA, f.longitudes[i], arena);
+        sumidero += (t != nullptr);
+        arena.reiniciar();
+    }
+    reportar(m, "parsearTrama (arena)", f.n);
+}
+
+static void benchAnalizar(const FlujoSintetico& f) {
+    Medicion m = iniciarMedicion();
+    for (size_t i = 0; i < f.n; i++) {
+        ResultadoTrama r = analizarTrama(f.lineas + i * LONGITUD_LINEA, f.longitudes[i]);
+        sumidero += r.trama.valor;
+    }
+    reportar(m, "analizarTrama", f.n);
+}
+
+static void benchRotar(const FlujoSintetico& f) {
+    RotorDeMapeo rotor;
+    Medicion m = iniciarMedicion();
+    for (size_t i = 0; i < f.n; i++) {
+        rotor.rotar((int)(i % 53) - 26);
+    }
+    sumidero += rotor.getCabeza();
+    reportar(m, "RotorDeMapeo::rotar", f.n);
+}
+
+static void benchGetMapeo(const FlujoSintetico& f) {
+    RotorDeMapeo rotor;
+    rotor.rotar(5);
+    Medicion m = iniciarMedicion();
+    for (size_t i = 0; i < f.n; i++) {
+        sumidero += rotor.getMapeo((char)f.tramas[i].valor);
+    }
+    reportar(m, "RotorDeMapeo::getMapeo", f.n);
+}
+
+/**
+ * @brief Rota y mapea con un rotor de tamaño configurable
+ * @details Usa un alfabeto en tiempo de ejecución igual al de AlfabetoASCII
+ *          para comparar con RotorFijo en igualdad de condiciones
+ */
+static void benchRotorDinamico(const FlujoSintetico& f) {
+    char ascii[AlfabetoASCII::TAMANO + 1];
+    for (int i = 0; i < AlfabetoASCII::TAMANO; i++) ascii[i] = AlfabetoASCII::simbolo(i);
+    ascii[AlfabetoASCII::TAMANO] = '\0';
+
+    RotorDeMapeo rotor(ascii);
+    Medicion m = iniciarMedicion();
+    for (size_t i = 0; i < f.n; i++) {
+        rotor.rotar(f.tramas[i].valor);
+        sumidero += rotor.getMapeo((char)f.tramas[i].valor);
+    }
+    reportar(m, "RotorDeMapeo rotar+mapeo (ASCII)", f.n);
+}
+
+static void benchRotorFijo(const FlujoSintetico& f) {
+    RotorFijo<AlfabetoASCII> rotor;
+    Medicion m = iniciarMedicion();
+    for (size_t i = 0; i < f.n; i++) {
+        rotor.rotar(f.tramas[i].valor);
+        sumidero += rotor.getMapeo((char)f.tramas[i].valor);
+    }
+    reportar(m, "RotorFijo rotar+mapeo (ASCII)", f.n);
+}
+
+static void benchInsertar(const FlujoSintetico& f) {
+    Medicion m = iniciarMedicion();
+    {
+        ListaDeCarga lista;
+        for (size_t i = 0; i < f.n; i++) {
+            lista.insertarAlFinal((char)f.tramas[i].valor);
+        }
+        sumidero += lista.getTamano();
+    }
+    reportar(m, "ListaDeCarga::insertarAlFinal", f.n);
+}
+
+static void benchPolimorfico(const FlujoSintetico& f) {
+    Medicion m = iniciarMedicion();
+    {
+        ListaDeCarga lista;
+        RotorDeMapeo rotor;
+        ArenaTramas arena;
+        for (size_t i = 0; i < f.n; i++) {
+            TramaBase* t = parsearTrama(f.lineas + i * LONGITUD_LINEA, f.longitudes[i], arena);
+            if (t != nullptr) {
+                t->procesar(&lista, &rotor);
+            }
+            arena.reiniciar();
+        }
+        sumidero += lista.getTamano();
+    }
+    reportar(m, "extremo a extremo (TramaBase)", f.n);
+}
+
+static void benchLote(const FlujoSintetico& f) {
+    Medicion m = iniciarMedicion();
+    {
+        ListaDeCarga lista;
+        RotorDeMapeo rotor;
+        sumidero += decodificarLote(f.tramas, f.n, lista, rotor);
+    }
+    reportar(m, "extremo a extremo (decodificarLote)", f.n);
+}
+
+static void benchLoteParalelo(const FlujoSintetico& f, int hilos) {
+    Medicion m = iniciarMedicion();
+    {
+        ListaDeCarga lista;
+        RotorDeMapeo rotor;
+        sumidero += decodificarLoteParalelo(f.tramas, f.n, lista, rotor, hilos);
+    }
+    reportar(m, "extremo a extremo (paralelo)", f.n);
+}
+
+// ============ PROGRAMA ============
+
+static void imprimirUso(const char* programa) {
+    printf("Uso: %s [opciones]\n", programa);
+    printf("  --tramas N       Número de tramas sintéticas (defecto 1000000)\n");
+    printf("  --map P          Porcentaje de tramas MAP, 0-100 (defecto 10)\n");
+    printf("  --semilla S      Semilla del generador (defecto 1)\n");
+    printf("  --hilos H        Hilos del decodificador paralelo (defecto: núcleos)\n");
+}
+
+int main(int argc, char* argv[]) {
+    size_t n = 1000000;
+    int porcentajeMap = 10;
+    unsigned semilla = 1;
+    int hilos = 0;
+
+    unsigned long long numero;
+    for (int i = 1; i < argc; i++) {
+        bool valida;
+        if (strcmp(argv[i], "--tramas") == 0 && i + 1 < argc) {
+            valida = leerEnteroSinSigno(argv[++i], 1, SIZE_MAX, numero);
+            if (valida) n = (size_t)numero;
+        } else if (strcmp(argv[i], "--map") == 0 && i + 1 < argc) {
+            valida = leerEntero(argv[++i], 0, 100, porcentajeMap);
+        } else if (strcmp(argv[i], "--semilla") == 0 && i + 1 < argc) {
+            valida = leerEnteroSinSigno(argv[++i], 0, UINT_MAX, numero);
+            if (valida) semilla = (unsigned)numero;
+        } else if (strcmp(argv[i], "--hilos") == 0 && i + 1 < argc) {
+            valida = leerEntero(argv[++i], 0, 256, hilos);
+        } else {
+            imprimirUso(argv[0]);
+            return strcmp(argv[i], "--ayuda") == 0 ? 0 : 1;
+        }
+        if (!valida) {
+            fprintf(stderr, "ERROR: valor no válido para %s: %s\n", argv[i - 1], argv[i]);
+            imprimirUso(argv[0]);
+            return 1;
+        }
+    }
+
+    FlujoSintetico flujo;
+    generarFlujo(flujo, n, porcentajeMap, semilla);
+
+    printf("PRT-7 bench: %zu tramas, %d%% MAP, semilla %u, kernel %s\n\n",
+           n, porcentajeMap, semilla, nombreKernelDecodificacion());
+    printf("%-34s %10s %14s %12s %12s\n",
+           "benchmark", "ns/trama", "tramas/s", "reservas/tr", "reservas");
+
+    benchAnalizar(flujo);
+    benchParsearHeap(flujo);
+    benchParsearArena(flujo);
+    benchRotar(flujo);
+    benchGetMapeo(flujo);
+    benchRotorDinamico(flujo);
+    benchRotorFijo(flujo);
+    benchInsertar(flujo);
+    benchPolimorfico(flujo);
+    benchLote(flujo);
+    benchLoteParalelo(flujo, hilos);
+
+    liberarFlujo(flujo);
+    return 0;
+}
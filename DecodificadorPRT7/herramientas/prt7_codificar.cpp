@@ -0,0 +1,337 @@
+/**
+ * @file prt7_codificar.cpp
+ * @brief Genera capturas PRT-7 a partir de texto plano
+ * @details Codifica un archivo (o stdin) con CodificadorPRT7 y escribe la
+ *          captura en texto o en el formato binario. Con --repetir produce
+ *          corpus de carga de varios GB a partir de un texto corto, y con
+ *          --verificar vuelve a decodificar la salida y la compara con la
+ *          entrada.
+ */
+
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+
+#include "Argumentos.h"
+#include "CapturaArchivo.h"
+#include "CodificadorPRT7.h"
+#include "DecodificadorLote.h"
+#include "FormatoBinario.h"
+#include "ListaDeCarga.h"
+#include "ParserTramas.h"
+#include "RotorDeMapeo.h"
+
+/// Tamaño del búfer de escritura de la captura de texto
+#define TAM_BUFFER_CODIFICADOR (1 << 20)
+
+/// Tramas que se decodifican juntas al verificar una captura de texto
+#define TRAMAS_LOTE_VERIFICACION 65536
+
+/**
+ * @struct OpcionesCodificar
+ * @brief Opciones de línea de comandos
+ */
+struct OpcionesCodificar {
+    OpcionesCodificador codificador; ///< Política de inserción de MAP
+    bool binario;            ///< Escribir el formato binario en lugar de texto
+    const char* cableado;    ///< Cableado del rotor (nullptr = identidad)
+    unsigned long long repetir; ///< Veces que se codifica la entrada
+    bool verificar;          ///< Decodificar la salida y compararla
+    const char* entrada;     ///< Texto plano ("-" = stdin)
+    const char* salida;      ///< Captura a generar ("-" = stdout, sólo texto)
+};
+
+/**
+ * @struct TextoEsperado
+ * @brief Recorre el texto que debería devolver el decodificador
+ */
+struct TextoEsperado {
+    const char* datos;           ///< Texto plano
+    size_t tamano;               ///< Bytes del texto plano
+    unsigned long long vueltas;  ///< Repeticiones restantes
+    size_t posicion;             ///< Posición en la vuelta actual
+    unsigned char canonico[256]; ///< Carácter que devuelve el decodificador
+    bool omitido[256];           ///< Caracteres que no llegan a la captura
+};
+
+static void imprimirUso(const char* programa) {
+    printf("Uso: %s [opciones] ENTRADA SALIDA\n", programa);
+    printf("  ENTRADA  Texto plano a codificar (\"-\" = stdin)\n");
+    printf("  SALIDA   Captura a generar (\"-\" = stdout, sólo en texto)\n");
+    printf("Opciones:\n");
+    printf("  --formato F        texto (defecto) o binario\n");
+    printf("  --politica P       Tramas MAP: ninguna, periodica, aleatoria (defecto) o adversaria\n");
+    printf("  --periodo N        Tramas LOAD entre dos MAP, exacto o en promedio (defecto 10)\n");
+    printf("  --rotacion-max R   Rotaciones en [-R, R] (defecto 26)\n");
+    printf("  --semilla S        Semilla del generador (defecto 1)\n");
+    printf("  --cableado PERM    Cableado del rotor, igual que en el decodificador\n");
+    printf("  --repetir K        Codifica la entrada K veces seguidas (defecto 1)\n");
+    printf("  --verificar        Decodifica la captura generada y la compara con la entrada\n");
+}
+
+static bool leerOpciones(int argc, char* argv[], OpcionesCodificar& op) {
+    op.binario = false;
+    op.cableado = nullptr;
+    op.repetir = 1;
+    op.verificar = false;
+    op.entrada = nullptr;
+    op.salida = nullptr;
+
+    int posicionales = 0;
+    unsigned long long numero;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--formato") == 0 && i + 1 < argc) {
+            const char* formato = argv[++i];
+            if (strcmp(formato, "binario") == 0) {
+                op.binario = true;
+            } else if (strcmp(formato, "texto") != 0) {
+                return false;
+            }
+        } else if (strcmp(argv[i], "--politica") == 0 && i + 1 < argc) {
+            if (!leerPoliticaMap(argv[++i], op.codificador.politica)) return false;
+        } else if (strcmp(argv[i], "--periodo") == 0 && i + 1 < argc) {
+            if (!leerEntero(argv[++i], 1, INT_MAX, op.codificador.periodo)) return false;
+        } else if (strcmp(argv[i], "--rotacion-max") == 0 && i + 1 < argc) {
+            if (!leerEntero(argv[++i], 0, INT_MAX, op.codificador.rotacionMaxima)) return false;
+        } else if (strcmp(argv[i], "--semilla") == 0 && i + 1 < argc) {
+            if (!leerEnteroSinSigno(argv[++i], 0, UINT_MAX, numero)) return false;
+            op.codificador.semilla = (unsigned)numero;
+        } else if (strcmp(argv[i], "--cableado") == 0 && i + 1 < argc) {
+            op.cableado = argv[++i];
+        } else if (strcmp(argv[i], "--repetir") == 0 && i + 1 < argc) {
+            if (!leerEnteroSinSigno(argv[++i], 1, ULLONG_MAX, op.repetir)) return false;
+        } else if (strcmp(argv[i], "--verificar") == 0) {
+            op.verificar = true;
+        } else if (argv[i][0] != '-' || strcmp(argv[i], "-") == 0) {
+            if (posicionales == 0) op.entrada = argv[i];
+            else if (posicionales == 1) op.salida = argv[i];
+            posicionales++;
+        } else {
+            return false;
+        }
+    }
+
+    if (posicionales != 2) {
+        return false;
+    }
+    if (strcmp(op.salida, "-") == 0 && (op.binario || op.verificar)) {
+        fprintf(stderr, "ERROR: la salida binaria o verificada debe ser un archivo\n");
+        return false;
+    }
+    return true;
+}
+
+// ============ VERIFICACIÓN ============
+
+static void iniciarEsperado(TextoEsperado& e, const CapturaPRT7& entrada,
+                            const OpcionesCodificar& op, const RotorDeMapeo& rotor) {
+    e.datos = entrada.datos;
+    e.tamano = entrada.tamano;
+    e.vueltas = entrada.tamano > 0 ? op.repetir : 0;
+    e.posicion = 0;
+
+    // Fuera del alfabeto un carácter no cambia y dentro sólo se pliega a
+    // mayúscula, así que el resultado no depende del desplazamiento
+    for (int c = 0; c < 256; c++) {
+        char codificado = rotor.desmapearEn((char)c, 0);
+        e.canonico[c] = (unsigned char)rotor.mapearEn(codificado, 0);
+        e.omitido[c] = !op.binario && (codificado == '\r' || codificado == '\n');
+    }
+}
+
+/**
+ * @brief Copia los siguientes caracteres esperados
+ * @return Caracteres copiados (0 al terminar)
+ */
+static size_t siguienteEsperado(TextoEsperado& e, char* destino, size_t maximo) {
+    size_t n = 0;
+    while (n < maximo && e.vueltas > 0) {
+        unsigned char c = (unsigned char)e.datos[e.posicion];
+        if (!e.omitido[c]) {
+            destino[n++] = (char)e.canonico[c];
+        }
+        if (++e.posicion == e.tamano) {
+            e.posicion = 0;
+            e.vueltas--;
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief Compara el contenido de una lista con los siguientes caracteres esperados
+ * @return Posición relativa de la primera diferencia, o -1 si coinciden
+ */
+static long long compararCarga(const ListaDeCarga& carga, TextoEsperado& e) {
+    static char esperado[TAM_BLOQUE_CODIFICADOR];
+    static char obtenido[TAM_BLOQUE_CODIFICADOR];
+
+    size_t total = carga.getTamano();
+    for (size_t desde = 0; desde < total; desde += TAM_BLOQUE_CODIFICADOR) {
+        size_t n = carga.extraerRango(desde, TAM_BLOQUE_CODIFICADOR, obtenido);
+        size_t m = siguienteEsperado(e, esperado, n);
+        for (size_t i = 0; i < n; i++) {
+            if (i >= m || esperado[i] != obtenido[i]) return (long long)(desde + i);
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Decodifica la captura generada y la compara con la entrada
+ * @return true si coinciden carácter a carácter
+ */
+static bool verificarCaptura(const OpcionesCodificar& op, const CapturaPRT7& entrada) {
+    CapturaPRT7 captura;
+    if (!abrirCaptura(op.salida, captura)) {
+        fprintf(stderr, "ERROR: No se pudo abrir %s para verificar\n", op.salida);
+        return false;
+    }
+
+    RotorDeMapeo rotor;
+    if (op.cableado != nullptr) rotor.setCableado(op.cableado);
+
+    TextoEsperado esperado;
+    iniciarEsperado(esperado, entrada, op, rotor);
+
+    unsigned long long verificados = 0;
+    long long diferencia = -1;
+    bool valida = true;
+
+    if (op.binario) {
+        ListaDeCarga carga;
+        unsigned long long tramas;
+        valida = decodificarCapturaBinaria(captura.datos, captura.tamano, carga, rotor, tramas);
+        diferencia = compararCarga(carga, esperado);
+        verificados = carga.getTamano();
+    } else {
+        // Lotes de tramas con el mismo decodificador que usa la reproducción
+        TramaCompacta* lote = new TramaCompacta[TRAMAS_LOTE_VERIFICACION];
+        size_t enLote = 0;
+        size_t posicion = 0;
+        const char* linea;
+        size_t longitud;
+        bool quedan = true;
+
+        while (quedan && diferencia < 0) {
+            quedan = siguienteLineaCaptura(captura, posicion, linea, longitud);
+            if (quedan) {
+                ResultadoTrama r = analizarTrama(linea, longitud);
+                if (r.error != TRAMA_OK) continue;
+                lote[enLote++] = r.trama;
+                if (enLote < TRAMAS_LOTE_VERIFICACION) continue;
+            }
+
+            ListaDeCarga carga;
+            decodificarLote(lote, enLote, carga, rotor);
+            diferencia = compararCarga(carga, esperado);
+            if (diferencia >= 0) diferencia += verificados;
+            verificados += carga.getTamano();
+            enLote = 0;
+        }
+        delete[] lote;
+    }
+
+    // Sobran caracteres esperados si la captura terminó antes de tiempo
+    char resto;
+    bool faltan = diferencia < 0 && siguienteEsperado(esperado, &resto, 1) > 0;
+    cerrarCaptura(captura);
+
+    if (!valida || diferencia >= 0 || faltan) {
+        fprintf(stderr, "VERIFICACIÓN FALLIDA: %s en el carácter %lld\n",
+                !valida ? "captura inválida" : (faltan ? "faltan caracteres" : "diferencia"),
+                diferencia >= 0 ? diferencia : (long long)verificados);
+        return false;
+    }
+    printf("Verificación correcta: %llu caracteres\n", verificados);
+    return true;
+}
+
+// ============ PROGRAMA ============
+
+int main(int argc, char* argv[]) {
+    OpcionesCodificar op;
+    if (!leerOpciones(argc, argv, op)) {
+        imprimirUso(argv[0]);
+        return 1;
+    }
+
+    RotorDeMapeo rotor;
+    if (op.cableado != nullptr && !rotor.setCableado(op.cableado)) {
+        fprintf(stderr, "ERROR: --cableado debe ser una permutación de \"%s\"\n", ALFABETO_PRT7);
+        return 1;
+    }
+
+    CapturaPRT7 entrada;
+    if (!abrirCaptura(op.entrada, entrada)) {
+        fprintf(stderr, "ERROR: No se pudo abrir %s\n", op.entrada);
+        return 1;
+    }
+
+    bool aStdout = strcmp(op.salida, "-") == 0;
+    FILE* archivo = aStdout ? stdout : fopen(op.salida, "wb");
+    if (archivo == nullptr) {
+        fprintf(stderr, "ERROR: No se pudo crear %s\n", op.salida);
+        cerrarCaptura(entrada);
+        return 1;
+    }
+    // El resumen va a stderr si la captura sale por stdout
+    FILE* informe = aStdout ? stderr : stdout;
+
+    std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+
+    EscritorSalida* texto = nullptr;
+    EscritorBinarioPRT7* binario = nullptr;
+    DestinoTramas* destino;
+    if (op.binario) {
+        setvbuf(archivo, nullptr, _IOFBF, TAM_BUFFER_CODIFICADOR);
+        binario = new EscritorBinarioPRT7(archivo);
+        destino = new DestinoBinario(*binario);
+    } else {
+        texto = new EscritorSalida(archivo, TAM_BUFFER_CODIFICADOR);
+        destino = new DestinoTexto(*texto);
+    }
+
+    CodificadorPRT7* codificador = new CodificadorPRT7(rotor, *destino, op.codificador);
+    for (unsigned long long k = 0; k < op.repetir; k++) {
+        codificador->codificar(entrada.datos, entrada.tamano);
+    }
+
+    bool ok = destino->terminar();
+    long long bytesSalida = aStdout ? -1 : (long long)ftell(archivo);
+    if (!aStdout && fclose(archivo) != 0) ok = false;
+
+    double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+
+    if (!ok) {
+        fprintf(stderr, "ERROR: Falló la escritura de %s\n", op.salida);
+    } else {
+        unsigned long long tramas = codificador->getTramasLoad() + codificador->getTramasMap();
+        fprintf(informe, "Tramas generadas: %llu (%llu LOAD, %llu MAP)\n",
+                tramas, codificador->getTramasLoad(), codificador->getTramasMap());
+        if (!op.binario) {
+            unsigned long long omitidas = static_cast<DestinoTexto*>(destino)->getOmitidas();
+            if (omitidas > 0) {
+                fprintf(informe, "Tramas LOAD omitidas (salto de línea): %llu\n", omitidas);
+            }
+        }
+        if (bytesSalida >= 0) {
+            fprintf(informe, "Tamaño: %lld bytes en %.3f s (%.1f MB/s)\n", bytesSalida, segundos,
+                    segundos > 0 ? bytesSalida / segundos / 1e6 : 0.0);
+        }
+    }
+
+    delete codificador;
+    delete destino;
+    delete binario;
+    delete texto;
+
+    if (ok && op.verificar) {
+        ok = verificarCaptura(op, entrada);
+    }
+
+    cerrarCaptura(entrada);
+    return ok ? 0 : 1;
+}
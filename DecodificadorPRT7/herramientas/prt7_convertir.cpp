@@ -0,0 +1,87 @@
+/**
+ * @file prt7_convertir.cpp
+ * @brief Convierte capturas PRT-7 de texto al formato binario compacto
+ * @details Lee líneas "L,X" / "M,N" (con o sin marcas de inicio y fin) y
+ *          escribe el formato descrito en FormatoBinario.h
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "CapturaArchivo.h"
+#include "FormatoBinario.h"
+#include "ParserTramas.h"
+
+/// Tamaño del búfer de escritura del archivo de salida
+#define TAM_BUFFER_SALIDA (1 << 20)
+
+static void imprimirUso(const char* programa) {
+    printf("Uso: %s ENTRADA SALIDA\n", programa);
+    printf("  ENTRADA  Captura de texto (\"-\" = stdin)\n");
+    printf("  SALIDA   Archivo binario a generar\n");
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        imprimirUso(argv[0]);
+        return 1;
+    }
+
+    CapturaPRT7 captura;
+    if (!abrirCaptura(argv[1], captura)) {
+        fprintf(stderr, "ERROR: No se pudo abrir la captura %s\n", argv[1]);
+        return 1;
+    }
+
+    FILE* salida = fopen(argv[2], "wb");
+    if (salida == nullptr) {
+        fprintf(stderr, "ERROR: No se pudo crear %s\n", argv[2]);
+        cerrarCaptura(captura);
+        return 1;
+    }
+    setvbuf(salida, nullptr, _IOFBF, TAM_BUFFER_SALIDA);
+
+    EscritorBinarioPRT7 escritor(salida);
+    unsigned long long invalidas = 0;
+
+    size_t posicion = 0;
+    const char* linea;
+    size_t longitud;
+
+    while (siguienteLineaCaptura(captura, posicion, linea, longitud)) {
+        ResultadoTrama r = analizarTrama(linea, longitud);
+
+        if (r.error == TRAMA_OK) {
+            if (r.trama.tipo == TRAMA_LOAD) {
+                escritor.agregarLoad((char)r.trama.valor);
+            } else {
+                escritor.agregarMap(r.trama.valor);
+            }
+        } else if (r.error != TRAMA_ERROR_VACIA) {
+            // Las marcas de control no se guardan; FIN termina la captura
+            if (longitud >= 20 && memcmp(linea, "FIN_TRANSMISION_PRT7", 20) == 0) {
+                break;
+            }
+            if (!(longitud >= 23 && memcmp(linea, "INICIO_TRANSMISION_PRT7", 23) == 0)) {
+                invalidas++;
+            }
+        }
+    }
+
+    bool ok = escritor.terminar();
+    long bytesSalida = ftell(salida);
+    fclose(salida);
+
+    if (!ok) {
+        fprintf(stderr, "ERROR: Falló la escritura de %s\n", argv[2]);
+        cerrarCaptura(captura);
+        return 1;
+    }
+
+    printf("Tramas convertidas: %llu\n", escritor.getTramas());
+    printf("Líneas inválidas omitidas: %llu\n", invalidas);
+    printf("Tamaño: %zu -> %ld bytes\n", captura.tamano, bytesSalida);
+
+    cerrarCaptura(captura);
+    return 0;
+}
@@ -0,0 +1,585 @@
+/**
+ * @file prt7_transmisor_pty.cpp
+ * @brief Transmisor PRT-7 sobre un pseudo-terminal para pruebas de carga
+ * @details Crea un par PTY y envía por el lado maestro tramas generadas o
+ *          leídas de una captura, a una tasa configurable. El lado esclavo
+ *          se comporta como un puerto serial: el decodificador lo abre con
+ *          abrirPuertoSerial igual que a un Arduino.
+ *
+ *          Con --loopback la propia herramienta abre el esclavo con
+ *          abrirPuertoSerial/leerTramas en un hilo receptor y mide tramas/s
+ *          sostenidas, tramas perdidas o alteradas y la latencia de toda la
+ *          pila serial, sin hardware. En ese modo el emisor intercala cada
+ *          INTERVALO_SECUENCIA tramas una trama MAP de secuencia con el
+ *          índice de la trama siguiente, y el receptor compara cada tramo
+ *          entre dos secuencias con lo enviado: una trama perdida sólo
+ *          afecta a su tramo.
+ */
+
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <termios.h>
+
+#include "Argumentos.h"
+#include "SerialPort.h"
+#include "ParserTramas.h"
+#include "CapturaArchivo.h"
+
+typedef std::chrono::steady_clock Reloj;
+
+/// Bytes máximos que se envían en una sola llamada a write()
+#define TAM_LOTE_ENVIO 4096
+
+/// Longitud máxima de una trama en texto ("M,-2147483648\r\n")
+#define LONGITUD_TRAMA 16
+
+/// Tramas de datos entre dos tramas de secuencia en modo loopback
+#define INTERVALO_SECUENCIA 64
+
+/// Las tramas MAP con rotación >= BASE_SECUENCIA son de secuencia: llevan
+/// BASE_SECUENCIA + índice de la siguiente trama / INTERVALO_SECUENCIA
+/// (las rotaciones generadas o de capturas reales son mucho menores)
+#define BASE_SECUENCIA (1 << 30)
+
+/**
+ * @struct OpcionesTransmisor
+ * @brief Opciones de línea de comandos
+ */
+struct OpcionesTransmisor {
+    long long tasa;          ///< Tramas por segundo (0 = sin límite)
+    size_t tramas;           ///< Tramas a generar
+    int porcentajeMap;       ///< Porcentaje de tramas MAP generadas
+    unsigned semilla;        ///< Semilla del generador
+    const char* captura;     ///< Captura de texto a reenviar (nullptr = generar)
+    int esperaMs;            ///< Espera antes de empezar a enviar
+    bool loopback;           ///< Medir con un receptor interno
+    int baudios;             ///< Velocidad configurada en el esclavo
+};
+
+/**
+ * @struct FlujoTramas
+ * @brief Tramas a enviar, ya convertidas a texto
+ */
+struct FlujoTramas {
+    size_t n;                ///< Número de tramas
+    TramaCompacta* tramas;   ///< Tramas en forma compacta
+    char* texto;             ///< n tramas de LONGITUD_TRAMA bytes
+    int* longitudes;         ///< Longitud de cada trama en texto
+};
+
+/**
+ * @struct EstadoLoopback
+ * @brief Datos compartidos entre el hilo emisor y el receptor
+ */
+struct EstadoLoopback {
+    long long* enviadoNs;               ///< Instante de envío de cada trama
+    std::atomic<size_t> enviadas;       ///< Tramas cuyo instante ya se publicó
+    std::atomic<bool> emisorTerminado;  ///< El emisor envió todo
+    size_t recibidas;                   ///< Tramas de datos recibidas
+    size_t perdidas;                    ///< Tramas enviadas que no llegaron
+    size_t alteradas;                   ///< Tramas recibidas distintas a las enviadas
+    size_t invalidas;                   ///< Líneas que no son tramas
+    long long* latenciasNs;             ///< Latencia de cada trama identificada
+    size_t medidas;                     ///< Entradas usadas de latenciasNs
+    TramaCompacta* tramo;               ///< Tramas recibidas desde la última secuencia
+    long long* llegadaNs;               ///< Instante de llegada de cada trama del tramo
+    size_t enTramo;                     ///< Tramas guardadas en tramo
+    size_t inicioTramo;                 ///< Índice enviado de la primera trama del tramo
+    Reloj::time_point primera;          ///< Recepción de la primera trama
+    Reloj::time_point ultima;           ///< Recepción de la última trama
+};
+
+static long long nanosDesde(Reloj::time_point origen) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Reloj::now() - origen).count();
+}
+
+static void imprimirUso(const char* programa) {
+    printf("Uso: %s [opciones]\n", programa);
+    printf("  --tasa N        Tramas por segundo (0 = lo más rápido posible; defecto 1000)\n");
+    printf("  --tramas N      Tramas a generar (defecto 100000)\n");
+    printf("  --map P         Porcentaje de tramas MAP generadas (defecto 10)\n");
+    printf("  --semilla S     Semilla del generador (defecto 1)\n");
+    printf("  --captura RUTA  Reenvía las tramas de una captura de texto\n");
+    printf("  --espera MS     Espera antes de transmitir (defecto 3000; 0 con --loopback)\n");
+    printf("  --baudios N     Velocidad del esclavo en modo loopback (defecto 115200)\n");
+    printf("  --loopback      Recibe en el mismo proceso y mide la pila serial\n");
+}
+
+static bool leerOpciones(int argc, char* argv[], OpcionesTransmisor& op) {
+    op.tasa = 1000;
+    op.tramas = 100000;
+    op.porcentajeMap = 10;
+    op.semilla = 1;
+    op.captura = nullptr;
+    op.esperaMs = -1;
+    op.loopback = false;
+    op.baudios = 115200;
+
+    unsigned long long numero;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--tasa") == 0 && i + 1 < argc) {
+            if (!leerEnteroSinSigno(argv[++i], 0, LLONG_MAX, numero)) return false;
+            op.tasa = (long long)numero;
+        } else if (strcmp(argv[i], "--tramas") == 0 && i + 1 < argc) {
+            if (!leerEnteroSinSigno(argv[++i], 0, SIZE_MAX, numero)) return false;
+            op.tramas = (size_t)numero;
+        } else if (strcmp(argv[i], "--map") == 0 && i + 1 < argc) {
+            if (!leerEntero(argv[++i], 0, 100, op.porcentajeMap)) return false;
+        } else if (strcmp(argv[i], "--semilla") == 0 && i + 1 < argc) {
+            if (!leerEnteroSinSigno(argv[++i], 0, UINT_MAX, numero)) return false;
+            op.semilla = (unsigned)numero;
+        } else if (strcmp(argv[i], "--captura") == 0 && i + 1 < argc) {
+            op.captura = argv[++i];
+        } else if (strcmp(argv[i], "--espera") == 0 && i + 1 < argc) {
+            if (!leerEntero(argv[++i], 0, INT_MAX, op.esperaMs)) return false;
+        } else if (strcmp(argv[i], "--baudios") == 0 && i + 1 < argc) {
+            if (!leerEntero(argv[++i], 1, INT_MAX, op.baudios)) return false;
+        } else if (strcmp(argv[i], "--loopback") == 0) {
+            op.loopback = true;
+        } else {
+            return false;
+        }
+    }
+
+    if (op.esperaMs < 0) {
+        op.esperaMs = op.loopback ? 0 : 3000;
+    }
+    return true;
+}
+
+// ============ PREPARACIÓN DE TRAMAS ============
+
+static void reservarFlujo(FlujoTramas& flujo, size_t n) {
+    flujo.n = n;
+    flujo.tramas = new TramaCompacta[n > 0 ? n : 1];
+    flujo.texto = new char[(n > 0 ? n : 1) * LONGITUD_TRAMA];
+    flujo.longitudes = new int[n > 0 ? n : 1];
+}
+
+static void formatearTrama(FlujoTramas& flujo, size_t i, TramaCompacta t) {
+    char* destino = flujo.texto + i * LONGITUD_TRAMA;
+    flujo.tramas[i] = t;
+    if (t.tipo == TRAMA_LOAD) {
+        flujo.longitudes[i] = snprintf(destino, LONGITUD_TRAMA, "L,%c\r\n", (char)t.valor);
+    } else {
+        flujo.longitudes[i] = snprintf(destino, LONGITUD_TRAMA, "M,%d\r\n", t.valor);
+    }
+}
+
+static void generarFlujo(FlujoTramas& flujo, const OpcionesTransmisor& op) {
+    const char alfabeto[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ ";
+    srand(op.semilla);
+    reservarFlujo(flujo, op.tramas);
+
+    for (size_t i = 0; i < flujo.n; i++) {
+        if (rand() % 100 < op.porcentajeMap) {
+            formatearTrama(flujo, i, crearTramaMap(rand() % 53 - 26));
+        } else {
+            formatearTrama(flujo, i, crearTramaLoad(alfabeto[rand() % 27]));
+        }
+    }
+}
+
+static bool cargarFlujo(FlujoTramas& flujo, const char* ruta) {
+    CapturaPRT7 captura;
+    if (!abrirCaptura(ruta, captura)) {
+        return false;
+    }
+
+    // Primera pasada: contar; segunda: formatear
+    size_t n = 0;
+    size_t posicion = 0;
+    const char* linea;
+    size_t longitud;
+    while (siguienteLineaCaptura(captura, posicion, linea, longitud)) {
+        if (analizarTrama(linea, longitud).error == TRAMA_OK) n++;
+    }
+
+    reservarFlujo(flujo, n);
+    size_t i = 0;
+    posicion = 0;
+    while (siguienteLineaCaptura(captura, posicion, linea, longitud)) {
+        ResultadoTrama r = analizarTrama(linea, longitud);
+        if (r.error == TRAMA_OK) {
+            formatearTrama(flujo, i++, r.trama);
+        }
+    }
+
+    cerrarCaptura(captura);
+    return true;
+}
+
+static void liberarFlujo(FlujoTramas& flujo) {
+    delete[] flujo.tramas;
+    delete[] flujo.texto;
+    delete[] flujo.longitudes;
+}
+
+// ============ PSEUDO-TERMINAL ============
+
+/**
+ * @brief Crea el par PTY y deja el maestro en modo crudo
+ * @param nombreEsclavo Salida: ruta del lado esclavo
+ * @param tam Tamaño de nombreEsclavo
+ * @return Descriptor del maestro o -1
+ */
+static int crearPTY(char* nombreEsclavo, size_t tam) {
+    int maestro = posix_openpt(O_RDWR | O_NOCTTY);
+    if (maestro == -1) return -1;
+
+    if (grantpt(maestro) != 0 || unlockpt(maestro) != 0) {
+        close(maestro);
+        return -1;
+    }
+
+    const char* nombre = ptsname(maestro);
+    if (nombre == nullptr) {
+        close(maestro);
+        return -1;
+    }
+    snprintf(nombreEsclavo, tam, "%s", nombre);
+
+    struct termios opciones;
+    if (tcgetattr(maestro, &opciones) == 0) {
+        cfmakeraw(&opciones);
+        tcsetattr(maestro, TCSANOW, &opciones);
+    }
+    return maestro;
+}
+
+static bool escribirTodo(int fd, const char* datos, size_t n) {
+    while (n > 0) {
+        ssize_t r = write(fd, datos, n);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        datos += r;
+        n -= r;
+    }
+    return true;
+}
+
+// ============ EMISOR ============
+
+/**
+ * @brief Envía todas las tramas respetando la tasa pedida
+ * @param estado Estado del loopback (nullptr si no se mide)
+ * @return Tramas enviadas
+ */
+static size_t transmitir(int maestro, const FlujoTramas& flujo, long long tasa,
+                         EstadoLoopback* estado, Reloj::time_point origen) {
+    char lote[TAM_LOTE_ENVIO];
+    Reloj::time_point inicio = Reloj::now();
+
+    const char inicioTx[] = "INICIO_TRANSMISION_PRT7\r\n";
+    if (!escribirTodo(maestro, inicioTx, sizeof(inicioTx) - 1)) return 0;
+
+    size_t i = 0;
+    while (i < flujo.n) {
+        // Tramas cuyo instante programado ya llegó
+        size_t limite = flujo.n;
+        if (tasa > 0) {
+            long long transcurridoNs = nanosDesde(inicio);
+            limite = (size_t)(transcurridoNs * (double)tasa / 1e9) + 1;
+            if (limite > flujo.n) limite = flujo.n;
+            if (limite <= i) {
+                long long siguienteNs = (long long)(i * 1e9 / (double)tasa);
+                std::this_thread::sleep_until(inicio + std::chrono::nanoseconds(siguienteNs));
+                continue;
+            }
+        }
+
+        // Juntar en un solo write() todas las tramas que quepan
+        // (con la de secuencia que precede a la trama, si la hay)
+        size_t usado = 0;
+        size_t desde = i;
+        while (i < limite && usado + 2 * LONGITUD_TRAMA <= sizeof(lote)) {
+            if (estado != nullptr && i % INTERVALO_SECUENCIA == 0) {
+                usado += snprintf(lote + usado, LONGITUD_TRAMA, "M,%d\r\n",
+                                  BASE_SECUENCIA + (int)(i / INTERVALO_SECUENCIA));
+            }
+            memcpy(lote + usado, flujo.texto + i * LONGITUD_TRAMA, flujo.longitudes[i]);
+            usado += flujo.longitudes[i];
+            i++;
+        }
+
+        if (estado != nullptr) {
+            long long ahora = nanosDesde(origen);
+            for (size_t k = desde; k < i; k++) {
+                estado->enviadoNs[k] = ahora;
+            }
+            estado->enviadas.store(i, std::memory_order_release);
+        }
+
+        if (!escribirTodo(maestro, lote, usado)) {
+            return desde;
+        }
+    }
+
+    const char finTx[] = "FIN_TRANSMISION_PRT7\r\n";
+    escribirTodo(maestro, finTx, sizeof(finTx) - 1);
+    return i;
+}
+
+// ============ RECEPTOR (LOOPBACK) ============
+
+/**
+ * @brief Anota una trama recibida como la trama k enviada
+ */
+static void identificarTrama(EstadoLoopback* estado, size_t k, long long llegadaNs) {
+    estado->latenciasNs[estado->medidas++] = llegadaNs - estado->enviadoNs[k];
+}
+
+/**
+ * @brief Compara las tramas del tramo en curso con las enviadas [inicioTramo, fin)
+ * @details Si llegaron tantas como se enviaron se comparan una a una. Si
+ *          faltan o sobran, cada trama recibida se compara con la enviada
+ *          en su misma posición contada desde el principio y desde el final
+ *          del tramo: las anteriores a una pérdida coinciden por el
+ *          principio y las posteriores por el final, así que sólo cuentan
+ *          como alteradas las que no coinciden de ninguna de las dos formas.
+ */
+static void cerrarTramo(EstadoLoopback* estado, const FlujoTramas* flujo, size_t fin) {
+    size_t esperadas = fin > estado->inicioTramo ? fin - estado->inicioTramo : 0;
+    size_t llegadas = estado->enTramo;
+
+    if (llegadas < esperadas) {
+        estado->perdidas += esperadas - llegadas;
+    }
+
+    for (size_t j = 0; j < llegadas; j++) {
+        const TramaCompacta& t = estado->tramo[j];
+        bool identificada = false;
+
+        if (j < esperadas) {
+            size_t k = estado->inicioTramo + j;
+            const TramaCompacta& e = flujo->tramas[k];
+            if (e.tipo == t.tipo && e.valor == t.valor) {
+                identificarTrama(estado, k, estado->llegadaNs[j]);
+                identificada = true;
+            }
+        }
+        if (!identificada && llegadas - j <= esperadas && llegadas != esperadas) {
+            size_t k = fin - (llegadas - j);
+            const TramaCompacta& e = flujo->tramas[k];
+            if (e.tipo == t.tipo && e.valor == t.valor) {
+                identificarTrama(estado, k, estado->llegadaNs[j]);
+                identificada = true;
+            }
+        }
+        if (!identificada) {
+            estado->alteradas++;
+        }
+    }
+
+    estado->inicioTramo = fin;
+    estado->enTramo = 0;
+}
+
+/**
+ * @brief Hilo receptor: lee el esclavo por la pila serial normal
+ */
+static void recibir(SerialHandle esclavo, const FlujoTramas* flujo,
+                    EstadoLoopback* estado, Reloj::time_point origen) {
+    LectorSerial* lector = new LectorSerial;
+    inicializarLectorSerial(*lector, esclavo);
+    TramaCompacta* lote = new TramaCompacta[TAM_BUFFER_LECTOR / 4];
+    bool fin = false;
+
+    while (!fin) {
+        int n = leerTramas(*lector, lote, TAM_BUFFER_LECTOR / 4);
+        if (n < 0) break;
+
+        long long ahora = nanosDesde(origen);
+        for (int i = 0; i < n && !fin; i++) {
+            const TramaCompacta& t = lote[i];
+            if (t.tipo == TRAMA_FIN) {
+                fin = true;
+                continue;
+            }
+            if (t.tipo == TRAMA_INICIO) continue;
+            if (t.tipo == TRAMA_INVALIDA) {
+                estado->invalidas++;
+                continue;
+            }
+
+            // Secuencia: el tramo anterior termina justo antes de su índice
+            if (t.tipo == TRAMA_MAP && t.valor >= BASE_SECUENCIA) {
+                size_t siguiente = (size_t)(t.valor - BASE_SECUENCIA) * INTERVALO_SECUENCIA;
+                if (siguiente >= estado->inicioTramo && siguiente <= flujo->n) {
+                    cerrarTramo(estado, flujo, siguiente);
+                    continue;
+                }
+            }
+
+            if (estado->recibidas == 0) estado->primera = Reloj::now();
+            estado->ultima = Reloj::now();
+            estado->recibidas++;
+
+            // Un tramo no puede tener más tramas que el flujo completo
+            if (estado->enTramo == flujo->n) {
+                estado->alteradas++;
+                continue;
+            }
+            estado->tramo[estado->enTramo] = t;
+            estado->llegadaNs[estado->enTramo] = ahora;
+            estado->enTramo++;
+        }
+
+        // Si el emisor ya terminó y no llega nada en 1 s, dar por perdidas
+        if (n == 0) {
+            int r = esperarDatosSerial(esclavo, 1000);
+            if (r < 0) break;
+            if (r == 0 && estado->emisorTerminado.load()) break;
+        }
+    }
+
+    // Lo que no llegó a cerrar una secuencia se compara hasta lo enviado
+    cerrarTramo(estado, flujo, estado->enviadas.load(std::memory_order_acquire));
+
+    delete[] lote;
+    delete lector;
+}
+
+static int compararLatencias(const void* a, const void* b) {
+    long long x = *(const long long*)a;
+    long long y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+static void reportarLoopback(const EstadoLoopback& estado, size_t enviadas) {
+    size_t recibidas = estado.recibidas;
+    size_t medidas = estado.medidas;
+    printf("\n=== Resultados loopback ===\n");
+    printf("Tramas enviadas:   %zu\n", enviadas);
+    printf("Tramas recibidas:  %zu\n", recibidas);
+    printf("Tramas perdidas:   %zu\n", estado.perdidas);
+    printf("Tramas alteradas:  %zu\n", estado.alteradas);
+    printf("Líneas inválidas:  %zu\n", estado.invalidas);
+
+    if (recibidas == 0) return;
+
+    double segundos = std::chrono::duration<double>(estado.ultima - estado.primera).count();
+    if (segundos > 0) {
+        printf("Tasa sostenida:    %.0f tramas/s\n", recibidas / segundos);
+    }
+
+    // La latencia sólo se mide en las tramas que se pudieron identificar
+    if (medidas == 0) return;
+    qsort(estado.latenciasNs, medidas, sizeof(long long), compararLatencias);
+    long long suma = 0;
+    for (size_t i = 0; i < medidas; i++) suma += estado.latenciasNs[i];
+
+    printf("Latencia (us): min %.1f  media %.1f  p50 %.1f  p99 %.1f  max %.1f\n",
+           estado.latenciasNs[0] / 1e3,
+           (double)suma / medidas / 1e3,
+           estado.latenciasNs[medidas / 2] / 1e3,
+           estado.latenciasNs[(size_t)(medidas * 0.99)] / 1e3,
+           estado.latenciasNs[medidas - 1] / 1e3);
+}
+
+// ============ PROGRAMA ============
+
+int main(int argc, char* argv[]) {
+    OpcionesTransmisor op;
+    if (!leerOpciones(argc, argv, op)) {
+        imprimirUso(argv[0]);
+        return 1;
+    }
+
+    FlujoTramas flujo;
+    if (op.captura != nullptr) {
+        if (!cargarFlujo(flujo, op.captura)) {
+            fprintf(stderr, "ERROR: No se pudo abrir la captura %s\n", op.captura);
+            return 1;
+        }
+    } else {
+        generarFlujo(flujo, op);
+    }
+
+    char nombreEsclavo[128];
+    int maestro = crearPTY(nombreEsclavo, sizeof(nombreEsclavo));
+    if (maestro == -1) {
+        fprintf(stderr, "ERROR: No se pudo crear el pseudo-terminal\n");
+        liberarFlujo(flujo);
+        return 1;
+    }
+
+    printf("PTY esclavo: %s\n", nombreEsclavo);
+    printf("Tramas: %zu, tasa: %lld tramas/s\n", flujo.n, op.tasa);
+    fflush(stdout);
+
+    Reloj::time_point origen = Reloj::now();
+    EstadoLoopback estado;
+    SerialHandle esclavo = INVALID_SERIAL_HANDLE;
+    std::thread receptor;
+
+    if (op.loopback) {
+        esclavo = abrirPuertoSerial(nombreEsclavo, op.baudios);
+        if (esclavo == INVALID_SERIAL_HANDLE) {
+            fprintf(stderr, "ERROR: abrirPuertoSerial falló sobre %s (%s)\n", nombreEsclavo,
+                    ultimoErrorSerial());
+            close(maestro);
+            liberarFlujo(flujo);
+            return 1;
+        }
+
+        estado.enviadoNs = new long long[flujo.n > 0 ? flujo.n : 1];
+        estado.latenciasNs = new long long[flujo.n > 0 ? flujo.n : 1];
+        estado.tramo = new TramaCompacta[flujo.n > 0 ? flujo.n : 1];
+        estado.llegadaNs = new long long[flujo.n > 0 ? flujo.n : 1];
+        estado.enviadas.store(0);
+        estado.emisorTerminado.store(false);
+        estado.recibidas = 0;
+        estado.perdidas = 0;
+        estado.alteradas = 0;
+        estado.invalidas = 0;
+        estado.medidas = 0;
+        estado.enTramo = 0;
+        estado.inicioTramo = 0;
+        receptor = std::thread(recibir, esclavo, &flujo, &estado, origen);
+    }
+
+    if (op.esperaMs > 0) {
+        printf("Esperando %d ms a que se conecte el decodificador...\n", op.esperaMs);
+        fflush(stdout);
+        std::this_thread::sleep_for(std::chrono::milliseconds(op.esperaMs));
+    }
+
+    Reloj::time_point inicio = Reloj::now();
+    size_t enviadas = transmitir(maestro, flujo, op.tasa, op.loopback ? &estado : nullptr, origen);
+    double segundos = std::chrono::duration<double>(Reloj::now() - inicio).count();
+
+    printf("Enviadas %zu tramas en %.3f s (%.0f tramas/s)\n",
+           enviadas, segundos, segundos > 0 ? enviadas / segundos : 0.0);
+
+    if (op.loopback) {
+        estado.emisorTerminado.store(true);
+        receptor.join();
+        reportarLoopback(estado, enviadas);
+        cerrarPuertoSerial(esclavo);
+        delete[] estado.enviadoNs;
+        delete[] estado.latenciasNs;
+        delete[] estado.tramo;
+        delete[] estado.llegadaNs;
+    } else {
+        // Dar tiempo al decodificador a vaciar el PTY antes de cerrarlo
+        tcdrain(maestro);
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
+
+    close(maestro);
+    liberarFlujo(flujo);
+    return 0;
+}
@@ -0,0 +1,54 @@
+# Prueba de ida y vuelta: codifica un mensaje con prt7_codificar y comprueba
+# que el decodificador lo recupera con el mismo cableado.
+#
+# Uso: cmake -DCODIFICAR=... -DDECODIFICADOR=... -DENTRADA=... -DPOLITICA=...
+#            -DFORMATO=texto|binario -DCABLEADO=... -DTRABAJO=... -P ida_y_vuelta.cmake
+
+foreach(variable CODIFICAR DECODIFICADOR ENTRADA POLITICA FORMATO CABLEADO TRABAJO)
+    if(NOT DEFINED ${variable})
+        message(FATAL_ERROR "Falta -D${variable}")
+    endif()
+endforeach()
+
+file(MAKE_DIRECTORY "${TRABAJO}")
+set(CAPTURA "${TRABAJO}/captura_${POLITICA}_${FORMATO}.prt7")
+
+# Codificar (--verificar ya decodifica la captura con el núcleo)
+execute_process(
+    COMMAND "${CODIFICAR}" --formato ${FORMATO} --politica ${POLITICA}
+            --semilla 7 --cableado "${CABLEADO}" --verificar
+            "${ENTRADA}" "${CAPTURA}"
+    RESULT_VARIABLE resultado
+    OUTPUT_VARIABLE salida
+    ERROR_VARIABLE errores
+)
+if(NOT resultado EQUAL 0)
+    message(FATAL_ERROR "prt7_codificar falló (${resultado}):\n${salida}${errores}")
+endif()
+
+# Decodificar con el programa principal
+execute_process(
+    COMMAND "${DECODIFICADOR}" --archivo "${CAPTURA}" --cableado "${CABLEADO}"
+            --nivel silencioso --formato ndjson
+    RESULT_VARIABLE resultado
+    OUTPUT_VARIABLE salida
+    ERROR_VARIABLE errores
+)
+if(NOT resultado EQUAL 0)
+    message(FATAL_ERROR "El decodificador falló (${resultado}):\n${salida}${errores}")
+endif()
+
+string(REGEX MATCH "\\{\"mensaje\":\"([^\"]*)\"" encontrado "${salida}")
+if(NOT encontrado)
+    message(FATAL_ERROR "No se encontró el mensaje en la salida:\n${salida}")
+endif()
+set(recuperado "${CMAKE_MATCH_1}")
+
+file(READ "${ENTRADA}" esperado)
+if(NOT recuperado STREQUAL esperado)
+    message(FATAL_ERROR "Mensaje distinto (${POLITICA}, ${FORMATO}):\n"
+                        "  esperado:   '${esperado}'\n"
+                        "  recuperado: '${recuperado}'")
+endif()
+
+file(REMOVE "${CAPTURA}")
@@ -0,0 +1,64 @@
+# Prueba de decodificación paralela: genera una captura grande con
+# prt7_codificar --repetir y comprueba que el decodificador produce la misma
+# salida con --hilos 1 que con --hilos N. La captura supera los umbrales a
+# partir de los cuales se reparten el análisis de líneas, el lote de tramas
+# y la carga binaria entre hilos.
+#
+# Uso: cmake -DCODIFICAR=... -DDECODIFICADOR=... -DENTRADA=... -DREPETIR=K
+#            -DFORMATO=texto|binario -DCABLEADO=... -DHILOS=N -DTRABAJO=...
+#            -P paralelo.cmake
+
+foreach(variable CODIFICAR DECODIFICADOR ENTRADA REPETIR FORMATO CABLEADO HILOS TRABAJO)
+    if(NOT DEFINED ${variable})
+        message(FATAL_ERROR "Falta -D${variable}")
+    endif()
+endforeach()
+
+file(MAKE_DIRECTORY "${TRABAJO}")
+set(CAPTURA "${TRABAJO}/paralelo_${FORMATO}.prt7")
+set(SALIDA_SECUENCIAL "${TRABAJO}/paralelo_${FORMATO}_1.txt")
+set(SALIDA_PARALELA "${TRABAJO}/paralelo_${FORMATO}_${HILOS}.txt")
+
+execute_process(
+    COMMAND "${CODIFICAR}" --formato ${FORMATO} --politica aleatoria --semilla 11
+            --cableado "${CABLEADO}" --repetir ${REPETIR}
+            "${ENTRADA}" "${CAPTURA}"
+    RESULT_VARIABLE resultado
+    OUTPUT_VARIABLE salida
+    ERROR_VARIABLE errores
+)
+if(NOT resultado EQUAL 0)
+    message(FATAL_ERROR "prt7_codificar falló (${resultado}):\n${salida}${errores}")
+endif()
+
+foreach(hilos 1 ${HILOS})
+    execute_process(
+        COMMAND "${DECODIFICADOR}" --archivo "${CAPTURA}" --cableado "${CABLEADO}"
+                --nivel silencioso --formato ndjson --hilos ${hilos}
+        RESULT_VARIABLE resultado
+        OUTPUT_FILE "${TRABAJO}/paralelo_${FORMATO}_${hilos}.txt"
+        ERROR_VARIABLE errores
+    )
+    if(NOT resultado EQUAL 0)
+        message(FATAL_ERROR "El decodificador falló con --hilos ${hilos} (${resultado}):\n${errores}")
+    endif()
+endforeach()
+
+# El mensaje completo debe tener K veces la longitud de la entrada
+file(READ "${ENTRADA}" mensaje)
+string(LENGTH "${mensaje}" largo)
+math(EXPR esperados "${largo} * ${REPETIR}")
+file(STRINGS "${SALIDA_SECUENCIAL}" resumen REGEX "\"caracteres\":${esperados}}")
+if(NOT resumen)
+    message(FATAL_ERROR "La salida con --hilos 1 no tiene ${esperados} caracteres")
+endif()
+
+execute_process(
+    COMMAND ${CMAKE_COMMAND} -E compare_files "${SALIDA_SECUENCIAL}" "${SALIDA_PARALELA}"
+    RESULT_VARIABLE distintas
+)
+if(distintas)
+    message(FATAL_ERROR "La salida con --hilos ${HILOS} difiere de la de --hilos 1")
+endif()
+
+file(REMOVE "${CAPTURA}" "${SALIDA_SECUENCIAL}" "${SALIDA_PARALELA}")
@@ -0,0 +1,87 @@
+/**
+ * @file prueba_kernels.cpp
+ * @brief Compara los kernels de decodificación con RotorDeMapeo::mapearEn
+ * @details Pasa los 256 valores de byte por cada kernel disponible en todos
+ *          los desplazamientos, con y sin cableado, y comprueba cada byte
+ *          contra el camino escalar del rotor. Termina con código 1 si
+ *          algún byte no coincide.
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "DecodificadorSIMD.h"
+#include "RotorDeMapeo.h"
+
+/// Kernels que se prueban si están disponibles
+static const char* const KERNELS[] = { "escalar", "ssse3", "avx2" };
+
+/// Repeticiones de los 256 valores; el byte extra deja una cola sin vectorizar
+#define VUELTAS_ENTRADA 3
+#define TAM_ENTRADA (256 * VUELTAS_ENTRADA + 7)
+
+/**
+ * @brief Comprueba un kernel con un rotor en todos sus desplazamientos
+ * @return Número de bytes que no coinciden
+ */
+static int probarKernel(KernelDecodificacion kernel, const RotorDeMapeo& rotor,
+                        const char* nombreKernel, const char* nombreRotor) {
+    char entrada[TAM_ENTRADA];
+    char salida[TAM_ENTRADA];
+    char enSitio[TAM_ENTRADA];
+    for (int i = 0; i < TAM_ENTRADA; i++) {
+        entrada[i] = (char)(unsigned char)((i * 97 + i / 256) & 0xFF);
+    }
+
+    int fallos = 0;
+    for (int desp = 0; desp < rotor.getTamano(); desp++) {
+        const unsigned char* tabla = rotor.getTablaMapeo(desp);
+
+        // Desde cada alineación de 0 a 31 para recorrer también las colas
+        for (int inicio = 0; inicio < 32; inicio++) {
+            size_t n = TAM_ENTRADA - inicio;
+            kernel(entrada + inicio, salida, n, tabla);
+            memcpy(enSitio, entrada + inicio, n);
+            kernel(enSitio, enSitio, n, tabla);
+
+            for (size_t i = 0; i < n; i++) {
+                char esperado = rotor.mapearEn(entrada[inicio + i], desp);
+                if (salida[i] != esperado || enSitio[i] != esperado) {
+                    if (fallos < 10) {
+                        printf("FALLO %s/%s desp %d: byte 0x%02X -> 0x%02X, se esperaba 0x%02X\n",
+                               nombreKernel, nombreRotor, desp,
+                               (unsigned char)entrada[inicio + i], (unsigned char)salida[i],
+                               (unsigned char)esperado);
+                    }
+                    fallos++;
+                }
+            }
+        }
+    }
+    return fallos;
+}
+
+int main() {
+    RotorDeMapeo identidad;
+    RotorDeMapeo cableado;
+    cableado.setCableado("QWERTY UIOPASDFGHJKLZXCVBNM");
+
+    int fallos = 0;
+    int probados = 0;
+    for (size_t k = 0; k < sizeof(KERNELS) / sizeof(KERNELS[0]); k++) {
+        KernelDecodificacion kernel = buscarKernelDecodificacion(KERNELS[k]);
+        if (kernel == nullptr) {
+            printf("%s: no disponible en esta CPU\n", KERNELS[k]);
+            continue;
+        }
+        fallos += probarKernel(kernel, identidad, KERNELS[k], "identidad");
+        fallos += probarKernel(kernel, cableado, KERNELS[k], "cableado");
+        probados++;
+    }
+
+    // El despacho debe dar lo mismo que el kernel que eligió
+    fallos += probarKernel(decodificarBloque, cableado, nombreKernelDecodificacion(), "despacho");
+
+    printf("%d kernels, %d fallos\n", probados, fallos);
+    return fallos == 0 ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+/**
+ * @file prueba_parser.cpp
+ * @brief Pruebas de analizarTrama y clasificarLinea
+ * @details Recorre una tabla de líneas con la trama o el error esperado.
+ *          Termina con código 1 si algún caso no coincide.
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "ParserTramas.h"
+
+/**
+ * @struct CasoTrama
+ * @brief Línea de entrada y resultado esperado de analizarTrama
+ */
+struct CasoTrama {
+    const char* linea;   ///< Línea sin terminar en salto de línea
+    ErrorTrama error;    ///< Error esperado (TRAMA_OK si es válida)
+    unsigned char tipo;  ///< Tipo esperado si es válida
+    int valor;           ///< Valor esperado si es válida
+};
+
+static const CasoTrama CASOS[] = {
+    // Válidas
+    { "L,A",            TRAMA_OK,            TRAMA_LOAD, 'A' },
+    { "l,z",            TRAMA_OK,            TRAMA_LOAD, 'z' },
+    { "L, ",            TRAMA_OK,            TRAMA_LOAD, ' ' },
+    { "  L,B  \r",      TRAMA_OK,            TRAMA_LOAD, 'B' },
+    { "M,5",            TRAMA_OK,            TRAMA_MAP,  5 },
+    { "M,-26",          TRAMA_OK,            TRAMA_MAP,  -26 },
+    { "m,+7",           TRAMA_OK,            TRAMA_MAP,  7 },
+    { "M,2147483647",   TRAMA_OK,            TRAMA_MAP,  2147483647 },
+    { "M,-2147483648",  TRAMA_OK,            TRAMA_MAP,  -2147483647 - 1 },
+
+    // Rotación no numérica
+    { "M,abc",          TRAMA_ERROR_NUMERO,  0, 0 },
+    { "M,-x",           TRAMA_ERROR_NUMERO,  0, 0 },
+
+    // Fuera de rango
+    { "M,2147483648",   TRAMA_ERROR_RANGO,   0, 0 },
+    { "M,-2147483649",  TRAMA_ERROR_RANGO,   0, 0 },
+    { "M,99999999999999999999", TRAMA_ERROR_RANGO, 0, 0 },
+
+    // Caracteres sobrantes
+    { "L,AB",           TRAMA_ERROR_BASURA,  0, 0 },
+    { "M,12abc",        TRAMA_ERROR_BASURA,  0, 0 },
+    { "M,3 4",          TRAMA_ERROR_BASURA,  0, 0 },
+    { "L,A x",          TRAMA_ERROR_BASURA,  0, 0 },
+
+    // Formato y tipo
+    { "",               TRAMA_ERROR_VACIA,   0, 0 },
+    { "   \r",          TRAMA_ERROR_VACIA,   0, 0 },
+    { "L",              TRAMA_ERROR_FORMATO, 0, 0 },
+    { "L,",             TRAMA_ERROR_FORMATO, 0, 0 },
+    { "M,",             TRAMA_ERROR_FORMATO, 0, 0 },
+    { "M,-",            TRAMA_ERROR_FORMATO, 0, 0 },
+    { "M;5",            TRAMA_ERROR_FORMATO, 0, 0 },
+    { "X,1",            TRAMA_ERROR_TIPO,    0, 0 },
+};
+
+/**
+ * @brief Comprueba un caso de la tabla
+ * @return true si analizarTrama y clasificarLinea dan lo esperado
+ */
+static bool comprobarCaso(const CasoTrama& caso) {
+    size_t longitud = strlen(caso.linea);
+    ResultadoTrama r = analizarTrama(caso.linea, longitud);
+
+    if (r.error != caso.error) {
+        printf("FALLO \"%s\": error %d (%s), se esperaba %d (%s)\n", caso.linea,
+               r.error, descripcionErrorTrama(r.error),
+               caso.error, descripcionErrorTrama(caso.error));
+        return false;
+    }
+    if (caso.error == TRAMA_OK &&
+        (r.trama.tipo != caso.tipo || r.trama.valor != caso.valor)) {
+        printf("FALLO \"%s\": trama %c,%d, se esperaba %c,%d\n", caso.linea,
+               r.trama.tipo, r.trama.valor, caso.tipo, caso.valor);
+        return false;
+    }
+
+    // clasificarLinea debe dar lo mismo (o nada si la línea está vacía)
+    TramaCompacta t;
+    bool hay = clasificarLinea(caso.linea, (int)longitud, t);
+    if (caso.error == TRAMA_ERROR_VACIA) {
+        if (hay) {
+            printf("FALLO \"%s\": clasificarLinea produjo una trama\n", caso.linea);
+            return false;
+        }
+        return true;
+    }
+
+    unsigned char tipoEsperado = caso.error == TRAMA_OK ? caso.tipo : (unsigned char)TRAMA_INVALIDA;
+    int valorEsperado = caso.error == TRAMA_OK ? caso.valor : (int)caso.error;
+    if (!hay || t.tipo != tipoEsperado || t.valor != valorEsperado) {
+        printf("FALLO \"%s\": clasificarLinea no coincide con analizarTrama\n", caso.linea);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Comprueba que las marcas de control se reconocen como tales
+ */
+static bool comprobarMarcas() {
+    TramaCompacta t;
+    bool ok = true;
+
+    if (!clasificarLinea(MARCA_INICIO_PRT7, (int)strlen(MARCA_INICIO_PRT7), t) ||
+        t.tipo != TRAMA_INICIO) {
+        printf("FALLO: no se reconoce %s\n", MARCA_INICIO_PRT7);
+        ok = false;
+    }
+
+    const char fin[] = ">> " MARCA_FIN_PRT7 " <<";
+    if (!clasificarLinea(fin, (int)strlen(fin), t) || t.tipo != TRAMA_FIN) {
+        printf("FALLO: no se reconoce %s dentro de una línea\n", MARCA_FIN_PRT7);
+        ok = false;
+    }
+    return ok;
+}
+
+int main() {
+    int fallos = 0;
+    const int numCasos = (int)(sizeof(CASOS) / sizeof(CASOS[0]));
+
+    for (int i = 0; i < numCasos; i++) {
+        if (!comprobarCaso(CASOS[i])) fallos++;
+    }
+    if (!comprobarMarcas()) fallos++;
+
+    printf("%d casos, %d fallos\n", numCasos + 1, fallos);
+    return fallos == 0 ? 0 : 1;
+}
@@ -0,0 +1,282 @@
+/**
+ * @file prueba_punto_control.cpp
+ * @brief Pruebas de reanudación desde archivos de control cortados
+ * @details Escribe varias instantáneas con un rotor cableado, corta el
+ *          archivo en distintos puntos del último registro (como una caída
+ *          a mitad de escritura) y comprueba que se reanuda desde la
+ *          instantánea anterior, que se puede seguir escribiendo y que un
+ *          rotor con otro cableado se rechaza. Termina con código 1 si
+ *          algo falla.
+ */
+
+#include <cstdio>
+#include <cstring>
+
+#include "ListaDeCarga.h"
+#include "PuntoControl.h"
+#include "RotorDeMapeo.h"
+
+/// Cableado no trivial usado en las pruebas
+static const char CABLEADO_PRUEBA[] = "QWERTY UIOPASDFGHJKLZXCVBNM";
+
+/// Archivo de control completo
+static const char RUTA_COMPLETO[] = "prueba_punto_control.pc";
+
+/// Copia cortada del archivo de control
+static const char RUTA_CORTADO[] = "prueba_punto_control_cortado.pc";
+
+/// Instantáneas que se escriben
+#define NUM_INSTANTANEAS 5
+
+/**
+ * @struct Instantanea
+ * @brief Lo que se guardó en cada instantánea
+ */
+struct Instantanea {
+    long long bytes;        ///< Longitud del archivo tras escribirla
+    long long tramas;       ///< Tramas válidas guardadas
+    long long invalidas;    ///< Líneas rechazadas guardadas
+    size_t caracteres;      ///< Longitud del mensaje
+    int desplazamiento;     ///< Desplazamiento del rotor
+};
+
+static int fallos = 0;
+
+/**
+ * @brief Anota un fallo si la condición no se cumple
+ */
+static void comprobar(bool condicion, const char* descripcion) {
+    if (!condicion) {
+        printf("FALLO: %s\n", descripcion);
+        fallos++;
+    }
+}
+
+/**
+ * @brief Obtiene la longitud de un archivo
+ */
+static long long longitudArchivo(const char* ruta) {
+    FILE* f = fopen(ruta, "rb");
+    if (f == nullptr) return -1;
+    fseek(f, 0, SEEK_END);
+    long long n = ftell(f);
+    fclose(f);
+    return n;
+}
+
+/**
+ * @brief Copia los primeros n bytes de un archivo en otro
+ */
+static bool copiarPrefijo(const char* origen, const char* destino, long long n) {
+    FILE* entrada = fopen(origen, "rb");
+    FILE* salida = fopen(destino, "wb");
+    bool ok = entrada != nullptr && salida != nullptr;
+
+    char bloque[4096];
+    while (ok && n > 0) {
+        size_t pedir = n < (long long)sizeof(bloque) ? (size_t)n : sizeof(bloque);
+        size_t leidos = fread(bloque, 1, pedir, entrada);
+        ok = leidos == pedir && fwrite(bloque, 1, leidos, salida) == leidos;
+        n -= (long long)leidos;
+    }
+
+    if (entrada != nullptr) fclose(entrada);
+    if (salida != nullptr) fclose(salida);
+    return ok;
+}
+
+/**
+ * @brief Carácter i del mensaje de prueba
+ */
+static char caracterMensaje(size_t i) {
+    return "ABCDEFGHIJKLMNOPQRSTUVWXYZ "[(i * 7 + i / 13) % 27];
+}
+
+/**
+ * @brief Comprueba que una lista contiene los primeros n caracteres del mensaje
+ */
+static bool mensajeCoincide(const ListaDeCarga& lista, size_t n) {
+    if (lista.getTamano() != n) return false;
+
+    char* texto = new char[n > 0 ? n : 1];
+    bool ok = lista.extraerRango(0, n, texto) == n;
+    for (size_t i = 0; ok && i < n; i++) {
+        ok = texto[i] == caracterMensaje(i);
+    }
+    delete[] texto;
+    return ok;
+}
+
+/**
+ * @brief Escribe NUM_INSTANTANEAS instantáneas de un mensaje que crece
+ */
+static bool escribirInstantaneas(Instantanea* instantaneas) {
+    ListaDeCarga lista;
+    RotorDeMapeo rotor;
+    rotor.setCableado(CABLEADO_PRUEBA);
+
+    PuntoControl control;
+    if (!control.abrir(RUTA_COMPLETO, lista, 0)) return false;
+
+    size_t caracteres = 0;
+    for (int k = 0; k < NUM_INSTANTANEAS; k++) {
+        // Instantáneas de tamaños distintos, una de ellas sin caracteres nuevos
+        size_t nuevos = k == 2 ? 0 : 1000 * (k + 1) + 17;
+        for (size_t i = 0; i < nuevos; i++) {
+            lista.insertarAlFinal(caracterMensaje(caracteres + i));
+        }
+        caracteres += nuevos;
+        rotor.rotar(k * 5 + 3);
+
+        if (!control.guardar(lista, rotor, 100 * (k + 1), k)) return false;
+        control.sincronizar();
+
+        instantaneas[k].bytes = longitudArchivo(RUTA_COMPLETO);
+        instantaneas[k].tramas = 100 * (k + 1);
+        instantaneas[k].invalidas = k;
+        instantaneas[k].caracteres = caracteres;
+        instantaneas[k].desplazamiento = rotor.getDesplazamiento();
+    }
+    control.cerrar();
+    return true;
+}
+
+/**
+ * @brief Carga un archivo con un rotor cableado y lo compara con una instantánea
+ */
+static void comprobarCarga(const char* ruta, const Instantanea& esperada, const char* caso) {
+    ListaDeCarga lista;
+    RotorDeMapeo rotor;
+    rotor.setCableado(CABLEADO_PRUEBA);
+    EstadoControl estado;
+
+    char descripcion[160];
+    snprintf(descripcion, sizeof(descripcion), "%s: se carga la instantánea anterior", caso);
+    bool cargado = cargarPuntoControl(ruta, lista, rotor, estado) == CONTROL_CARGADO;
+    comprobar(cargado, descripcion);
+    if (!cargado) return;
+
+    snprintf(descripcion, sizeof(descripcion), "%s: contadores y rotor", caso);
+    comprobar(estado.tramasRecibidas == esperada.tramas &&
+              estado.tramasInvalidas == esperada.invalidas &&
+              estado.bytesValidos == esperada.bytes &&
+              rotor.getDesplazamiento() == esperada.desplazamiento, descripcion);
+
+    snprintf(descripcion, sizeof(descripcion), "%s: mensaje recuperado", caso);
+    comprobar(mensajeCoincide(lista, esperada.caracteres), descripcion);
+}
+
+/**
+ * @brief Corta el último registro en varios puntos y reanuda desde cada corte
+ */
+static void probarCortes(const Instantanea* instantaneas) {
+    const Instantanea& penultima = instantaneas[NUM_INSTANTANEAS - 2];
+    const Instantanea& ultima = instantaneas[NUM_INSTANTANEAS - 1];
+
+    const long long cortes[] = {
+        penultima.bytes + 1,                         // Sólo parte de la firma
+        penultima.bytes + TAM_CABECERA_CONTROL - 1,  // Cabecera incompleta
+        penultima.bytes + TAM_CABECERA_CONTROL + 10, // Caracteres a medias
+        ultima.bytes - 1                             // Falta el último byte
+    };
+
+    for (size_t i = 0; i < sizeof(cortes) / sizeof(cortes[0]); i++) {
+        char caso[64];
+        snprintf(caso, sizeof(caso), "corte en el byte %lld", cortes[i]);
+        comprobar(copiarPrefijo(RUTA_COMPLETO, RUTA_CORTADO, cortes[i]), "copiar el prefijo");
+        comprobarCarga(RUTA_CORTADO, penultima, caso);
+    }
+
+    // El archivo completo devuelve la última instantánea
+    comprobarCarga(RUTA_COMPLETO, ultima, "archivo completo");
+
+    // Un corte dentro del primer registro no deja nada que reanudar
+    comprobar(copiarPrefijo(RUTA_COMPLETO, RUTA_CORTADO, instantaneas[0].bytes - 1),
+              "copiar el prefijo");
+    ListaDeCarga lista;
+    RotorDeMapeo rotor;
+    rotor.setCableado(CABLEADO_PRUEBA);
+    EstadoControl estado;
+    comprobar(cargarPuntoControl(RUTA_CORTADO, lista, rotor, estado) == CONTROL_VACIO,
+              "primer registro cortado: no hay instantáneas");
+}
+
+/**
+ * @brief Reanuda desde un archivo cortado, sigue escribiendo y vuelve a cargar
+ */
+static void probarContinuacion(const Instantanea* instantaneas) {
+    const Instantanea& penultima = instantaneas[NUM_INSTANTANEAS - 2];
+    comprobar(copiarPrefijo(RUTA_COMPLETO, RUTA_CORTADO, penultima.bytes + 25),
+              "copiar el prefijo");
+
+    ListaDeCarga lista;
+    RotorDeMapeo rotor;
+    rotor.setCableado(CABLEADO_PRUEBA);
+    EstadoControl estado;
+    if (cargarPuntoControl(RUTA_CORTADO, lista, rotor, estado) != CONTROL_CARGADO) {
+        comprobar(false, "continuación: cargar el archivo cortado");
+        return;
+    }
+
+    // abrir descarta el registro cortado antes de agregar
+    PuntoControl control;
+    comprobar(control.abrir(RUTA_CORTADO, lista, estado.bytesValidos), "continuación: abrir");
+    for (size_t i = 0; i < 500; i++) {
+        lista.insertarAlFinal(caracterMensaje(penultima.caracteres + i));
+    }
+    rotor.rotar(11);
+    comprobar(control.guardar(lista, rotor, penultima.tramas + 600, penultima.invalidas + 1),
+              "continuación: guardar");
+    control.cerrar();
+
+    Instantanea esperada;
+    esperada.tramas = penultima.tramas + 600;
+    esperada.invalidas = penultima.invalidas + 1;
+    esperada.caracteres = penultima.caracteres + 500;
+    esperada.desplazamiento = rotor.getDesplazamiento();
+    esperada.bytes = penultima.bytes + TAM_CABECERA_CONTROL + 500;
+    comprobar(longitudArchivo(RUTA_CORTADO) == esperada.bytes,
+              "continuación: el registro cortado se descartó");
+    comprobarCarga(RUTA_CORTADO, esperada, "continuación");
+}
+
+/**
+ * @brief Un rotor con otro cableado o sin cableado no puede reanudar
+ */
+static void probarOtroRotor() {
+    ListaDeCarga lista;
+    RotorDeMapeo identidad;
+    EstadoControl estado;
+    comprobar(cargarPuntoControl(RUTA_COMPLETO, lista, identidad, estado) == CONTROL_INCOMPATIBLE,
+              "rotor sin cableado: se rechaza");
+
+    ListaDeCarga otraLista;
+    RotorDeMapeo otro;
+    otro.setCableado("MNBVCXZLKJHGFDSAPOIUYTREWQ ");
+    comprobar(cargarPuntoControl(RUTA_COMPLETO, otraLista, otro, estado) == CONTROL_INCOMPATIBLE,
+              "otro cableado: se rechaza");
+
+    ListaDeCarga sinArchivo;
+    RotorDeMapeo rotor;
+    comprobar(cargarPuntoControl("prueba_punto_control_inexistente.pc", sinArchivo, rotor,
+                                 estado) == CONTROL_VACIO,
+              "archivo inexistente: no hay instantáneas");
+}
+
+int main() {
+    Instantanea instantaneas[NUM_INSTANTANEAS];
+    if (!escribirInstantaneas(instantaneas)) {
+        printf("FALLO: no se pudo escribir %s\n", RUTA_COMPLETO);
+        return 1;
+    }
+
+    probarCortes(instantaneas);
+    probarContinuacion(instantaneas);
+    probarOtroRotor();
+
+    remove(RUTA_COMPLETO);
+    remove(RUTA_CORTADO);
+
+    printf("%d fallos\n", fallos);
+    return fallos == 0 ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file ArenaTramas.cpp
+ * @brief Implementación de la arena de tramas
+ */
+
+#include "ArenaTramas.h"
+
+/// Alineación de cada reserva (suficiente para objetos con vtable)
+static const size_t ALINEACION_ARENA = alignof(std::max_align_t);
+
+BloqueArena::BloqueArena(size_t bytes)
+    : siguiente(nullptr), capacidad(bytes), datos(new unsigned char[bytes]) {
+}
+
+BloqueArena::~BloqueArena() {
+    delete[] datos;
+}
+
+ArenaTramas::ArenaTramas(size_t bytesPorBloque)
+    : primero(nullptr), actual(nullptr), usado(0), tamBloque(bytesPorBloque) {
+    primero = new BloqueArena(tamBloque);
+    actual = primero;
+}
+
+ArenaTramas::~ArenaTramas() {
+    BloqueArena* bloque = primero;
+    while (bloque != nullptr) {
+        BloqueArena* siguiente = bloque->siguiente;
+        delete bloque;
+        bloque = siguiente;
+    }
+}
+
+void* ArenaTramas::reservar(size_t bytes) {
+    bytes = (bytes + ALINEACION_ARENA - 1) & ~(ALINEACION_ARENA - 1);
+
+    while (usado + bytes > actual->capacidad) {
+        // Pasar al siguiente bloque, creándolo si hace falta
+        if (actual->siguiente == nullptr) {
+            size_t capacidad = bytes > tamBloque ? bytes : tamBloque;
+            actual->siguiente = new BloqueArena(capacidad);
+        }
+        actual = actual->siguiente;
+        usado = 0;
+    }
+
+    void* p = actual->datos + usado;
+    usado += bytes;
+    return p;
+}
+
+void ArenaTramas::reiniciar() {
+    actual = primero;
+    usado = 0;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file ArenaTramas.h
+ * @brief Arena de memoria para objetos TramaLoad y TramaMap
+ * @details Evita un new/delete por cada línea recibida: las tramas se
+ *          construyen sobre bloques reservados una sola vez y se descartan
+ *          todas juntas con reiniciar() al terminar cada lote
+ */
+
+#ifndef ARENA_TRAMAS_H
+#define ARENA_TRAMAS_H
+
+#include <cstddef>
+#include <new>
+
+/**
+ * @struct BloqueArena
+ * @brief Bloque de memoria de la arena (lista simplemente enlazada)
+ */
+struct BloqueArena {
+    BloqueArena* siguiente; ///< Siguiente bloque de la arena
+    size_t capacidad;       ///< Bytes utilizables en datos
+    unsigned char* datos;   ///< Memoria del bloque
+
+    /**
+     * @brief Constructor que reserva la memoria del bloque
+     * @param bytes Capacidad del bloque
+     */
+    explicit BloqueArena(size_t bytes);
+
+    /**
+     * @brief Destructor que libera la memoria del bloque
+     */
+    ~BloqueArena();
+};
+
+/**
+ * @class ArenaTramas
+ * @brief Asignador por bloques que se reinicia por lote
+ * @details Sólo debe alojar objetos cuyo destructor no libere recursos
+ *          (TramaLoad y TramaMap): reiniciar() no llama a los destructores.
+ *          Si un lote no cabe se agrega un bloque, que se conserva para los
+ *          lotes siguientes; en régimen estable no hay reservas en el heap.
+ */
+class ArenaTramas {
+private:
+    BloqueArena* primero; ///< Primer bloque
+    BloqueArena* actual;  ///< Bloque donde se está reservando
+    size_t usado;         ///< Bytes usados en el bloque actual
+    size_t tamBloque;     ///< Capacidad de los bloques nuevos
+
+public:
+    /**
+     * @brief Constructor
+     * @param bytesPorBloque Capacidad de cada bloque (por defecto 16 KiB)
+     */
+    explicit ArenaTramas(size_t bytesPorBloque = 16 * 1024);
+
+    /**
+     * @brief Destructor que libera todos los bloques
+     */
+    ~ArenaTramas();
+
+    ArenaTramas(const ArenaTramas&) = delete;
+    ArenaTramas& operator=(const ArenaTramas&) = delete;
+
+    /**
+     * @brief Reserva memoria alineada dentro de la arena
+     * @param bytes Tamaño solicitado
+     * @return Puntero a la memoria reservada
+     */
+    void* reservar(size_t bytes);
+
+    /**
+     * @brief Descarta todos los objetos del lote actual
+     * @details Conserva los bloques para reutilizarlos
+     */
+    void reiniciar();
+
+    /**
+     * @brief Construye un objeto dentro de la arena
+     * @param arg Argumento del constructor de T
+     * @return Puntero al objeto construido
+     */
+    template <typename T, typename A>
+    T* crear(A arg) {
+        return new (reservar(sizeof(T))) T(arg);
+    }
+};
+
+#endif // ARENA_TRAMAS_H
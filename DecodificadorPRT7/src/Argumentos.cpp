@@ -0,0 +1,36 @@
+/**
+ * @file Argumentos.cpp
+ * @brief Implementación de la lectura de argumentos numéricos
+ */
+
+#include "Argumentos.h"
+#include <cerrno>
+#include <cstdlib>
+
+bool leerEntero(const char* texto, long minimo, long maximo, int& valor) {
+    char* fin;
+    errno = 0;
+    long leido = strtol(texto, &fin, 10);
+    if (fin == texto || *fin != '\0' || errno == ERANGE || leido < minimo || leido > maximo) {
+        return false;
+    }
+    valor = (int)leido;
+    return true;
+}
+
+bool leerEnteroSinSigno(const char* texto, unsigned long long minimo,
+                        unsigned long long maximo, unsigned long long& valor) {
+    // strtoull acepta "-1" y lo convierte en el máximo: rechazarlo antes
+    const char* p = texto;
+    while (*p == ' ' || *p == '\t') p++;
+    if (*p == '-') return false;
+
+    char* fin;
+    errno = 0;
+    unsigned long long leido = strtoull(texto, &fin, 10);
+    if (fin == texto || *fin != '\0' || errno == ERANGE || leido < minimo || leido > maximo) {
+        return false;
+    }
+    valor = leido;
+    return true;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file Argumentos.h
+ * @brief Lectura estricta de argumentos numéricos de la línea de comandos
+ * @details Compartida por el decodificador y las herramientas: un número
+ *          con caracteres sobrantes o fuera de rango se rechaza en vez de
+ *          convertirse en 0 como con atoi.
+ */
+
+#ifndef ARGUMENTOS_H
+#define ARGUMENTOS_H
+
+/**
+ * @brief Convierte un argumento numérico completo dentro de un rango
+ * @param texto Argumento de la línea de comandos
+ * @param minimo Valor mínimo aceptado
+ * @param maximo Valor máximo aceptado
+ * @param valor Salida: el número leído (sin cambios si se rechaza)
+ * @return false si el texto está vacío, tiene caracteres sobrantes o se
+ *         sale del rango
+ */
+bool leerEntero(const char* texto, long minimo, long maximo, int& valor);
+
+/**
+ * @brief Igual que leerEntero para valores sin signo de 64 bits
+ * @param texto Argumento de la línea de comandos (no admite signo '-')
+ * @param minimo Valor mínimo aceptado
+ * @param maximo Valor máximo aceptado
+ * @param valor Salida: el número leído (sin cambios si se rechaza)
+ * @return false si el texto está vacío, es negativo, tiene caracteres
+ *         sobrantes o se sale del rango
+ */
+bool leerEnteroSinSigno(const char* texto, unsigned long long minimo,
+                        unsigned long long maximo, unsigned long long& valor);
+
+#endif // ARGUMENTOS_H
@@ -0,0 +1,314 @@
+/**
+ * @file CapturaArchivo.cpp
+ * @brief Implementación del acceso a capturas grabadas
+ */
+
+#include "CapturaArchivo.h"
+#include "ParserTramas.h"
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+/// Tamaño inicial del búfer para capturas leídas de stdin
+static const size_t TAM_INICIAL_STDIN = 1 << 20;
+
+/// Bytes por hilo por debajo de los cuales no compensa repartir un tramo
+static const size_t MIN_BYTES_HILO = 1 << 18;
+
+/**
+ * @brief Lee un flujo completo a un búfer creciente
+ */
+static bool leerFlujoCompleto(FILE* flujo, CapturaPRT7& captura) {
+    size_t capacidad = TAM_INICIAL_STDIN;
+    size_t usado = 0;
+    char* buffer = (char*)malloc(capacidad);
+    if (buffer == nullptr) return false;
+
+    for (;;) {
+        if (usado == capacidad) {
+            char* mayor = (char*)realloc(buffer, capacidad * 2);
+            if (mayor == nullptr) {
+                free(buffer);
+                return false;
+            }
+            buffer = mayor;
+            capacidad *= 2;
+        }
+
+        size_t n = fread(buffer + usado, 1, capacidad - usado, flujo);
+        if (n == 0) break;
+        usado += n;
+    }
+
+    captura.datos = buffer;
+    captura.tamano = usado;
+    captura.proyectada = false;
+    captura.recurso = buffer;
+    return true;
+}
+
+#ifdef _WIN32
+// ============ IMPLEMENTACIÓN WINDOWS ============
+
+#include <windows.h>
+
+bool abrirCaptura(const char* ruta, CapturaPRT7& captura) {
+    captura.datos = nullptr;
+    captura.tamano = 0;
+    captura.proyectada = false;
+    captura.recurso = nullptr;
+
+    if (strcmp(ruta, "-") == 0) {
+        return leerFlujoCompleto(stdin, captura);
+    }
+
+    HANDLE archivo = CreateFileA(ruta, GENERIC_READ, FILE_SHARE_READ, NULL,
+                                 OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (archivo == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER tamano;
+    if (!GetFileSizeEx(archivo, &tamano)) {
+        CloseHandle(archivo);
+        return false;
+    }
+    if (tamano.QuadPart == 0) {
+        CloseHandle(archivo);
+        return true;
+    }
+
+    HANDLE proyeccion = CreateFileMappingA(archivo, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(archivo);
+    if (proyeccion == NULL) {
+        return false;
+    }
+
+    void* vista = MapViewOfFile(proyeccion, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(proyeccion);
+    if (vista == NULL) {
+        return false;
+    }
+
+    captura.datos = (const char*)vista;
+    captura.tamano = (size_t)tamano.QuadPart;
+    captura.proyectada = true;
+    captura.recurso = vista;
+    return true;
+}
+
+void cerrarCaptura(CapturaPRT7& captura) {
+    if (captura.proyectada) {
+        UnmapViewOfFile(captura.recurso);
+    } else {
+        free(captura.recurso);
+    }
+    captura.datos = nullptr;
+    captura.tamano = 0;
+    captura.recurso = nullptr;
+}
+
+#else
+// ============ IMPLEMENTACIÓN LINUX ============
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+bool abrirCaptura(const char* ruta, CapturaPRT7& captura) {
+    captura.datos = nullptr;
+    captura.tamano = 0;
+    captura.proyectada = false;
+    captura.recurso = nullptr;
+
+    if (strcmp(ruta, "-") == 0) {
+        return leerFlujoCompleto(stdin, captura);
+    }
+
+    int fd = open(ruta, O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return false;
+    }
+
+    // Tuberías, FIFOs y dispositivos no se pueden proyectar
+    if (!S_ISREG(info.st_mode)) {
+        FILE* flujo = fdopen(fd, "rb");
+        if (flujo == nullptr) {
+            close(fd);
+            return false;
+        }
+        bool ok = leerFlujoCompleto(flujo, captura);
+        fclose(flujo);
+        return ok;
+    }
+
+    if (info.st_size == 0) {
+        close(fd);
+        return true;
+    }
+
+    void* vista = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (vista == MAP_FAILED) {
+        return false;
+    }
+
+    // La captura se recorre una sola vez de principio a fin
+    madvise(vista, info.st_size, MADV_SEQUENTIAL);
+
+    captura.datos = (const char*)vista;
+    captura.tamano = (size_t)info.st_size;
+    captura.proyectada = true;
+    captura.recurso = vista;
+    return true;
+}
+
+void cerrarCaptura(CapturaPRT7& captura) {
+    if (captura.proyectada) {
+        munmap(captura.recurso, captura.tamano);
+    } else {
+        free(captura.recurso);
+    }
+    captura.datos = nullptr;
+    captura.tamano = 0;
+    captura.recurso = nullptr;
+}
+
+#endif
+
+// ============ RECORRIDO DE LÍNEAS (COMÚN) ============
+
+bool siguienteLineaCaptura(const CapturaPRT7& captura, size_t& posicion,
+                           const char*& linea, size_t& longitud) {
+    if (posicion >= captura.tamano) {
+        return false;
+    }
+
+    const char* inicio = captura.datos + posicion;
+    size_t restante = captura.tamano - posicion;
+    const char* salto = (const char*)memchr(inicio, '\n', restante);
+
+    size_t largo = salto ? (size_t)(salto - inicio) : restante;
+    posicion += salto ? largo + 1 : largo;
+
+    if (largo > 0 && inicio[largo - 1] == '\r') {
+        largo--;
+    }
+
+    linea = inicio;
+    longitud = largo;
+    return true;
+}
+
+/**
+ * @brief Clasifica las líneas de [inicio, fin) en orden
+ * @return Número de tramas escritas en tramas
+ */
+static size_t clasificarParte(const char* inicio, const char* fin, TramaCompacta* tramas) {
+    size_t n = 0;
+    while (inicio < fin) {
+        const char* salto = (const char*)memchr(inicio, '\n', fin - inicio);
+        size_t largo = salto ? (size_t)(salto - inicio) : (size_t)(fin - inicio);
+        const char* siguiente = salto ? salto + 1 : fin;
+
+        if (largo > 0 && inicio[largo - 1] == '\r') {
+            largo--;
+        }
+        if (largo > INT_MAX) {
+            largo = INT_MAX;
+        }
+
+        if (clasificarLinea(inicio, (int)largo, tramas[n])) {
+            n++;
+        }
+        inicio = siguiente;
+    }
+    return n;
+}
+
+/**
+ * @brief Hilo de clasificarTramoCaptura: clasifica una parte y guarda el conteo
+ */
+static void clasificarParteHilo(const char* inicio, const char* fin,
+                                TramaCompacta* tramas, size_t* n) {
+    *n = clasificarParte(inicio, fin, tramas);
+}
+
+size_t clasificarTramoCaptura(const CapturaPRT7& captura, size_t& posicion, size_t maximo,
+                              TramaCompacta* tramas, int numHilos) {
+    if (posicion >= captura.tamano) {
+        return 0;
+    }
+
+    const char* inicio = captura.datos + posicion;
+    size_t restante = captura.tamano - posicion;
+    size_t largo = restante;
+
+    // Cortar en el último salto de línea; si no hay, tomar la línea entera
+    if (restante > maximo) {
+        largo = 0;
+        for (size_t i = maximo; i > 0; i--) {
+            if (inicio[i - 1] == '\n') {
+                largo = i;
+                break;
+            }
+        }
+        if (largo == 0) {
+            const char* salto = (const char*)memchr(inicio + maximo, '\n', restante - maximo);
+            largo = salto ? (size_t)(salto - inicio) + 1 : restante;
+        }
+    }
+    posicion += largo;
+
+    if (numHilos <= 0) {
+        numHilos = (int)std::thread::hardware_concurrency();
+    }
+    size_t partes = largo / MIN_BYTES_HILO;
+    if (partes > (size_t)numHilos) partes = numHilos;
+    if (partes <= 1) {
+        return clasificarParte(inicio, inicio + largo, tramas);
+    }
+
+    // Límites de las partes, movidos hasta el inicio de la línea siguiente
+    size_t* limites = new size_t[partes + 1];
+    size_t* conteos = new size_t[partes];
+    std::thread* hilos = new std::thread[partes];
+
+    limites[0] = 0;
+    limites[partes] = largo;
+    for (size_t k = 1; k < partes; k++) {
+        size_t corte = largo * k / partes;
+        if (corte < limites[k - 1]) corte = limites[k - 1];
+        const char* salto = (const char*)memchr(inicio + corte, '\n', largo - corte);
+        limites[k] = salto ? (size_t)(salto - inicio) + 1 : largo;
+    }
+
+    for (size_t k = 0; k < partes; k++) {
+        hilos[k] = std::thread(clasificarParteHilo, inicio + limites[k], inicio + limites[k + 1],
+                               tramas + limites[k] / 2, conteos + k);
+    }
+    for (size_t k = 0; k < partes; k++) {
+        hilos[k].join();
+    }
+
+    // Compactar: cada parte empezó en la mitad de su desplazamiento
+    size_t total = conteos[0];
+    for (size_t k = 1; k < partes; k++) {
+        memmove(tramas + total, tramas + limites[k] / 2, conteos[k] * sizeof(TramaCompacta));
+        total += conteos[k];
+    }
+
+    delete[] hilos;
+    delete[] conteos;
+    delete[] limites;
+    return total;
+}
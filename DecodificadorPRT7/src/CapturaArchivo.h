@@ -0,0 +1,71 @@
+/**
+ * @file CapturaArchivo.h
+ * @brief Acceso a capturas PRT-7 grabadas en archivo o recibidas por stdin
+ * @details Los archivos regulares se proyectan en memoria (mmap en Linux,
+ *          MapViewOfFile en Windows) para recorrer las líneas directamente
+ *          sobre las páginas del archivo. stdin y las tuberías se leen
+ *          completos a un búfer en memoria.
+ */
+
+#ifndef CAPTURA_ARCHIVO_H
+#define CAPTURA_ARCHIVO_H
+
+#include <cstddef>
+#include "TramaCompacta.h"
+
+/**
+ * @struct CapturaPRT7
+ * @brief Contenido de una captura disponible como un bloque contiguo
+ */
+struct CapturaPRT7 {
+    const char* datos; ///< Primer byte de la captura
+    size_t tamano;     ///< Número de bytes
+    bool proyectada;   ///< true si datos apunta a una proyección del archivo
+    void* recurso;     ///< Proyección o búfer a liberar al cerrar
+};
+
+/**
+ * @brief Abre una captura
+ * @param ruta Ruta del archivo, o "-" para leer stdin
+ * @param captura Captura a completar
+ * @return true si se pudo abrir
+ */
+bool abrirCaptura(const char* ruta, CapturaPRT7& captura);
+
+/**
+ * @brief Libera la proyección o el búfer de una captura
+ * @param captura Captura abierta con abrirCaptura
+ */
+void cerrarCaptura(CapturaPRT7& captura);
+
+/**
+ * @brief Obtiene la siguiente línea de una captura sin copiarla
+ * @param captura Captura abierta
+ * @param posicion Posición actual; se avanza hasta la línea siguiente
+ * @param linea Salida: primer carácter de la línea (no termina en '\0')
+ * @param longitud Salida: longitud sin "\r\n"
+ * @return false cuando ya no quedan líneas
+ */
+bool siguienteLineaCaptura(const CapturaPRT7& captura, size_t& posicion,
+                           const char*& linea, size_t& longitud);
+
+/**
+ * @brief Analiza de una vez un tramo de líneas completas de una captura
+ * @param captura Captura abierta
+ * @param posicion Posición actual; se avanza hasta el final del tramo
+ * @param maximo Bytes aproximados del tramo (se corta en el último salto de
+ *               línea; una línea más larga se toma entera)
+ * @param tramas Salida: tramas y marcas en orden; necesita capacidad para
+ *               (maximo + 1) / 2 tramas
+ * @param numHilos Hilos a usar (0 = número de núcleos disponibles)
+ * @return Número de tramas escritas (las líneas vacías no producen tramas)
+ * @details Equivale a recorrer el tramo con siguienteLineaCaptura y
+ *          clasificarLinea. Con varios hilos el tramo se reparte en partes
+ *          que empiezan en un inicio de línea; cada parte escribe a partir
+ *          de la mitad de su desplazamiento (una trama ocupa al menos dos
+ *          bytes con su salto de línea) y después se compactan en orden.
+ */
+size_t clasificarTramoCaptura(const CapturaPRT7& captura, size_t& posicion, size_t maximo,
+                              TramaCompacta* tramas, int numHilos);
+
+#endif // CAPTURA_ARCHIVO_H
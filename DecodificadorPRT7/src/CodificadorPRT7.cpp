@@ -0,0 +1,180 @@
+/**
+ * @file CodificadorPRT7.cpp
+ * @brief Implementación del codificador de tramas PRT-7
+ */
+
+#include "CodificadorPRT7.h"
+#include "RotorDeMapeo.h"
+#include "FormatoBinario.h"
+#include "DecodificadorSIMD.h"
+#include <climits>
+#include <cstring>
+
+/// Tramas LOAD que se formatean juntas antes de pasarlas al escritor
+static const int LOADS_POR_ESCRITURA = 256;
+
+// ============ DESTINOS ============
+
+DestinoTexto::DestinoTexto(EscritorSalida& salida) : salida(salida), omitidas(0) {
+    salida.escribirCadena("INICIO_TRANSMISION_PRT7\n");
+}
+
+void DestinoTexto::agregarLoads(const char* datos, size_t n) {
+    char lineas[LOADS_POR_ESCRITURA * 4];
+
+    while (n > 0) {
+        size_t trozo = n < (size_t)LOADS_POR_ESCRITURA ? n : (size_t)LOADS_POR_ESCRITURA;
+        char* p = lineas;
+        for (size_t i = 0; i < trozo; i++) {
+            char c = datos[i];
+            if (c == '\r' || c == '\n') {
+                omitidas++;
+                continue;
+            }
+            p[0] = 'L';
+            p[1] = ',';
+            p[2] = c;
+            p[3] = '\n';
+            p += 4;
+        }
+        salida.escribir(lineas, p - lineas);
+        datos += trozo;
+        n -= trozo;
+    }
+}
+
+void DestinoTexto::agregarMap(int rotacion) {
+    salida.escribirFormato("M,%d\n", rotacion);
+}
+
+bool DestinoTexto::terminar() {
+    salida.escribirCadena("FIN_TRANSMISION_PRT7\n");
+    return salida.vaciar();
+}
+
+void DestinoBinario::agregarLoads(const char* datos, size_t n) {
+    escritor.agregarLoads(datos, n);
+}
+
+void DestinoBinario::agregarMap(int rotacion) {
+    escritor.agregarMap(rotacion);
+}
+
+bool DestinoBinario::terminar() {
+    return escritor.terminar();
+}
+
+// ============ CODIFICADOR ============
+
+CodificadorPRT7::CodificadorPRT7(const RotorDeMapeo& rotor, DestinoTramas& destino,
+                                 const OpcionesCodificador& opciones)
+    : rotor(rotor), destino(destino), opciones(opciones),
+      desplazamiento(rotor.getDesplazamiento()),
+      estado(opciones.semilla * 0x9E3779B97F4A7C15ULL + 1), restantes(0),
+      tramasLoad(0), tramasMap(0) {
+    if (this->opciones.periodo < 1) this->opciones.periodo = 1;
+    if (this->opciones.rotacionMaxima < 0) this->opciones.rotacionMaxima = 0;
+    restantes = siguienteRacha();
+}
+
+unsigned long long CodificadorPRT7::aleatorio() {
+    // xorshift64: rápido y reproducible con la misma semilla
+    estado ^= estado << 13;
+    estado ^= estado >> 7;
+    estado ^= estado << 17;
+    return estado;
+}
+
+int CodificadorPRT7::rotacionAleatoria() {
+    unsigned long long rango = 2ULL * opciones.rotacionMaxima + 1;
+    return (int)(aleatorio() % rango) - opciones.rotacionMaxima;
+}
+
+long long CodificadorPRT7::siguienteRacha() {
+    switch (opciones.politica) {
+    case MAP_PERIODICA:
+        return opciones.periodo;
+    case MAP_ALEATORIA:
+        // Uniforme en [1, 2 * periodo - 1]: periodo en promedio
+        return 1 + (long long)(aleatorio() % (2ULL * opciones.periodo - 1));
+    case MAP_ADVERSARIA:
+        // Rachas mínimas: ningún bloque aprovecha los kernels vectorizados
+        return 1 + (long long)(aleatorio() & 1);
+    case MAP_NINGUNA:
+    default:
+        return LLONG_MAX;
+    }
+}
+
+void CodificadorPRT7::emitirMap(int rotacion) {
+    destino.agregarMap(rotacion);
+    tramasMap++;
+
+    // Misma acumulación que el decodificador
+    const int tamano = rotor.getTamano();
+    if (tamano > 0) {
+        int r = rotacion % tamano;
+        if (r < 0) r += tamano;
+        desplazamiento += r;
+        if (desplazamiento >= tamano) desplazamiento -= tamano;
+    }
+}
+
+void CodificadorPRT7::emitirMaps() {
+    if (opciones.politica != MAP_ADVERSARIA) {
+        emitirMap(rotacionAleatoria());
+        return;
+    }
+
+    // Ráfagas de 1 a 3 MAP con los valores que más suelen romper un
+    // decodificador: nulas, múltiplos del tamaño, extremos de int
+    const int tamano = rotor.getTamano() > 0 ? rotor.getTamano() : 1;
+    int rafaga = 1 + (int)(aleatorio() % 3);
+    for (int i = 0; i < rafaga; i++) {
+        switch (aleatorio() % 8) {
+        case 0:  emitirMap(0); break;
+        case 1:  emitirMap(tamano * (1 + (int)(aleatorio() % 1000))); break;
+        case 2:  emitirMap(-tamano); break;
+        case 3:  emitirMap(INT_MAX); break;
+        case 4:  emitirMap(INT_MIN); break;
+        case 5:  emitirMap(tamano - 1); break;
+        default: emitirMap(rotacionAleatoria()); break;
+        }
+    }
+}
+
+void CodificadorPRT7::codificar(const char* texto, size_t n) {
+    while (n > 0) {
+        if (restantes == 0) {
+            emitirMaps();
+            restantes = siguienteRacha();
+        }
+
+        size_t trozo = n < TAM_BLOQUE_CODIFICADOR ? n : TAM_BLOQUE_CODIFICADOR;
+        if ((long long)trozo > restantes) trozo = (size_t)restantes;
+
+        // La tabla inversa deshace exactamente lo que aplicará el decodificador
+        decodificarBloque(texto, bloque, trozo, rotor.getTablaInversa(desplazamiento));
+        destino.agregarLoads(bloque, trozo);
+
+        tramasLoad += trozo;
+        restantes -= trozo;
+        texto += trozo;
+        n -= trozo;
+    }
+}
+
+bool leerPoliticaMap(const char* nombre, PoliticaMap& politica) {
+    if (strcmp(nombre, "ninguna") == 0) {
+        politica = MAP_NINGUNA;
+    } else if (strcmp(nombre, "periodica") == 0) {
+        politica = MAP_PERIODICA;
+    } else if (strcmp(nombre, "aleatoria") == 0) {
+        politica = MAP_ALEATORIA;
+    } else if (strcmp(nombre, "adversaria") == 0) {
+        politica = MAP_ADVERSARIA;
+    } else {
+        return false;
+    }
+    return true;
+}
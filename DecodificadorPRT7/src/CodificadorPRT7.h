@@ -0,0 +1,229 @@
+/**
+ * @file CodificadorPRT7.h
+ * @brief Codificador de texto plano a tramas PRT-7
+ * @details Produce el flujo de tramas que, decodificado con un rotor del
+ *          mismo alfabeto y cableado, devuelve el texto original. Cada LOAD
+ *          lleva el carácter transformado con la tabla inversa del rotor en
+ *          el desplazamiento vigente; las tramas MAP se intercalan según una
+ *          política configurable. Las rachas entre dos MAP se codifican en
+ *          bloque con los mismos kernels que decodifican.
+ */
+
+#ifndef CODIFICADOR_PRT7_H
+#define CODIFICADOR_PRT7_H
+
+#include <cstddef>
+#include "EscritorSalida.h"
+
+class RotorDeMapeo;
+class EscritorBinarioPRT7;
+
+/// Caracteres que se codifican de una vez entre dos consultas de política
+#define TAM_BLOQUE_CODIFICADOR 4096
+
+/**
+ * @enum PoliticaMap
+ * @brief Cuándo se intercalan tramas MAP entre las LOAD
+ */
+enum PoliticaMap {
+    MAP_NINGUNA,    ///< Sólo tramas LOAD
+    MAP_PERIODICA,  ///< Una MAP cada periodo tramas LOAD
+    MAP_ALEATORIA,  ///< Rachas LOAD de longitud aleatoria, periodo en promedio
+    MAP_ADVERSARIA  ///< Peor caso: rachas de 1-2 LOAD, ráfagas de MAP con
+                    ///< rotaciones nulas, múltiplos del tamaño y extremos de int
+};
+
+/**
+ * @struct OpcionesCodificador
+ * @brief Parámetros del codificador
+ */
+struct OpcionesCodificador {
+    PoliticaMap politica; ///< Política de inserción de MAP
+    int periodo;          ///< Tramas LOAD entre dos MAP (exacto o en promedio)
+    int rotacionMaxima;   ///< Las rotaciones normales están en [-max, max]
+    unsigned semilla;     ///< Semilla del generador pseudoaleatorio
+
+    /**
+     * @brief Constructor con los valores por defecto
+     */
+    OpcionesCodificador()
+        : politica(MAP_ALEATORIA), periodo(10), rotacionMaxima(26), semilla(1) {}
+};
+
+/**
+ * @class DestinoTramas
+ * @brief Recibe las tramas que produce el codificador
+ */
+class DestinoTramas {
+public:
+    virtual ~DestinoTramas() {}
+
+    /**
+     * @brief Agrega una racha de tramas LOAD
+     * @param datos Caracteres ya codificados
+     * @param n Número de tramas
+     */
+    virtual void agregarLoads(const char* datos, size_t n) = 0;
+
+    /**
+     * @brief Agrega una trama MAP
+     * @param rotacion Rotación de la trama
+     */
+    virtual void agregarMap(int rotacion) = 0;
+
+    /**
+     * @brief Escribe lo pendiente
+     * @return true si todas las escrituras tuvieron éxito
+     */
+    virtual bool terminar() = 0;
+};
+
+/**
+ * @class DestinoTexto
+ * @brief Escribe las tramas como líneas "L,X" / "M,N" entre las marcas de
+ *        inicio y fin
+ * @details Un carácter '\\r' o '\\n' no se puede transmitir en una línea
+ *          LOAD: esas tramas se omiten y se cuentan
+ */
+class DestinoTexto : public DestinoTramas {
+private:
+    EscritorSalida& salida;        ///< Escritor de destino
+    unsigned long long omitidas;   ///< Tramas LOAD no representables
+
+public:
+    /**
+     * @brief Constructor: escribe la marca de inicio
+     * @param salida Escritor de destino
+     */
+    explicit DestinoTexto(EscritorSalida& salida);
+
+    DestinoTexto(const DestinoTexto&) = delete;
+    DestinoTexto& operator=(const DestinoTexto&) = delete;
+
+    void agregarLoads(const char* datos, size_t n);
+    void agregarMap(int rotacion);
+
+    /**
+     * @brief Escribe la marca de fin y vacía el escritor
+     * @return true si todas las escrituras tuvieron éxito
+     */
+    bool terminar();
+
+    /**
+     * @brief Obtiene las tramas LOAD omitidas
+     * @return Tramas con '\\r' o '\\n'
+     */
+    unsigned long long getOmitidas() const { return omitidas; }
+};
+
+/**
+ * @class DestinoBinario
+ * @brief Escribe las tramas en el formato binario de FormatoBinario.h
+ */
+class DestinoBinario : public DestinoTramas {
+private:
+    EscritorBinarioPRT7& escritor; ///< Escritor binario de destino
+
+public:
+    /**
+     * @brief Constructor
+     * @param escritor Escritor binario de destino
+     */
+    explicit DestinoBinario(EscritorBinarioPRT7& escritor) : escritor(escritor) {}
+
+    DestinoBinario(const DestinoBinario&) = delete;
+    DestinoBinario& operator=(const DestinoBinario&) = delete;
+
+    void agregarLoads(const char* datos, size_t n);
+    void agregarMap(int rotacion);
+    bool terminar();
+};
+
+/**
+ * @class CodificadorPRT7
+ * @brief Convierte texto plano en tramas PRT-7
+ * @details No modifica el rotor: lleva su propio desplazamiento, que parte
+ *          del desplazamiento actual del rotor y avanza con cada MAP igual
+ *          que en el decodificador. Se puede llamar a codificar varias veces
+ *          para procesar la entrada por partes.
+ */
+class CodificadorPRT7 {
+private:
+    const RotorDeMapeo& rotor;       ///< Rotor compartido con el decodificador
+    DestinoTramas& destino;          ///< Destino de las tramas
+    OpcionesCodificador opciones;    ///< Política y parámetros
+    int desplazamiento;              ///< Desplazamiento tras las MAP emitidas
+    unsigned long long estado;       ///< Estado del generador xorshift64
+    long long restantes;             ///< Tramas LOAD hasta la siguiente MAP
+    unsigned long long tramasLoad;   ///< Tramas LOAD emitidas
+    unsigned long long tramasMap;    ///< Tramas MAP emitidas
+    char bloque[TAM_BLOQUE_CODIFICADOR]; ///< Caracteres codificados de la racha actual
+
+    /**
+     * @brief Siguiente número del generador pseudoaleatorio
+     */
+    unsigned long long aleatorio();
+
+    /**
+     * @brief Sortea una rotación en [-rotacionMaxima, rotacionMaxima]
+     */
+    int rotacionAleatoria();
+
+    /**
+     * @brief Longitud de la siguiente racha LOAD según la política
+     */
+    long long siguienteRacha();
+
+    /**
+     * @brief Emite una trama MAP y avanza el desplazamiento
+     */
+    void emitirMap(int rotacion);
+
+    /**
+     * @brief Emite la MAP (o ráfaga de MAP) que corresponde entre dos rachas
+     */
+    void emitirMaps();
+
+public:
+    /**
+     * @brief Constructor
+     * @param rotor Rotor con el alfabeto y cableado del decodificador
+     * @param destino Destino de las tramas
+     * @param opciones Política de inserción de MAP
+     */
+    CodificadorPRT7(const RotorDeMapeo& rotor, DestinoTramas& destino,
+                    const OpcionesCodificador& opciones);
+
+    /**
+     * @brief Codifica texto plano
+     * @param texto Caracteres a transmitir
+     * @param n Número de caracteres
+     */
+    void codificar(const char* texto, size_t n);
+
+    /**
+     * @brief Obtiene las tramas LOAD emitidas
+     * @return Una por carácter codificado
+     */
+    unsigned long long getTramasLoad() const { return tramasLoad; }
+
+    /**
+     * @brief Obtiene las tramas MAP emitidas
+     * @return Tramas MAP intercaladas
+     */
+    unsigned long long getTramasMap() const { return tramasMap; }
+
+private:
+    CodificadorPRT7(const CodificadorPRT7&);
+    CodificadorPRT7& operator=(const CodificadorPRT7&);
+};
+
+/**
+ * @brief Convierte el nombre de una política en su valor
+ * @param nombre "ninguna", "periodica", "aleatoria" o "adversaria"
+ * @param politica Salida
+ * @return false si el nombre no es válido
+ */
+bool leerPoliticaMap(const char* nombre, PoliticaMap& politica);
+
+#endif // CODIFICADOR_PRT7_H
@@ -0,0 +1,113 @@
+/**
+ * @file ColaTramas.cpp
+ * @brief Implementación de la cola circular productor/consumidor
+ */
+
+#include "ColaTramas.h"
+#include <chrono>
+
+ColaTramasSPSC::ColaTramasSPSC(size_t capacidadMinima)
+    : elementos(nullptr), mascara(0), cabeza(0), cola(0), cabezaVista(0),
+      rechazos(0), maximoOcupado(0), cerrada(false), consumidorEsperando(false) {
+    size_t capacidad = 2;
+    while (capacidad < capacidadMinima) {
+        capacidad <<= 1;
+    }
+    elementos = new TramaCompacta[capacidad];
+    mascara = capacidad - 1;
+}
+
+ColaTramasSPSC::~ColaTramasSPSC() {
+    delete[] elementos;
+}
+
+size_t ColaTramasSPSC::insertar(const TramaCompacta* tramas, size_t n) {
+    const size_t capacidad = mascara + 1;
+    size_t escritura = cola.load(std::memory_order_relaxed);
+
+    // Releer la cabeza compartida sólo si la copia local no deja espacio
+    size_t libres = capacidad - (escritura - cabezaVista);
+    if (libres < n) {
+        cabezaVista = cabeza.load(std::memory_order_acquire);
+        libres = capacidad - (escritura - cabezaVista);
+    }
+
+    size_t cuantas = n < libres ? n : libres;
+    if (cuantas < n) {
+        rechazos.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    for (size_t i = 0; i < cuantas; i++) {
+        elementos[(escritura + i) & mascara] = tramas[i];
+    }
+    cola.store(escritura + cuantas, std::memory_order_release);
+
+    if (cuantas > 0) {
+        despertarConsumidor();
+    }
+
+    return cuantas;
+}
+
+size_t ColaTramasSPSC::extraer(TramaCompacta* destino, size_t maximo) {
+    size_t lectura = cabeza.load(std::memory_order_relaxed);
+    size_t disponibles = cola.load(std::memory_order_acquire) - lectura;
+
+    // La ocupación se mide aquí: el consumidor ve la cola recién leída y su
+    // propia cabeza, mientras que cabezaVista del productor puede estar atrasada
+    if (disponibles > maximoOcupado.load(std::memory_order_relaxed)) {
+        maximoOcupado.store(disponibles, std::memory_order_relaxed);
+    }
+
+    size_t cuantas = maximo < disponibles ? maximo : disponibles;
+    for (size_t i = 0; i < cuantas; i++) {
+        destino[i] = elementos[(lectura + i) & mascara];
+    }
+    cabeza.store(lectura + cuantas, std::memory_order_release);
+
+    return cuantas;
+}
+
+bool ColaTramasSPSC::esperarDatos(int timeoutMs) {
+    std::unique_lock<std::mutex> bloqueo(mutexEspera);
+
+    // Anunciar la espera antes de volver a mirar la cola (ver despertarConsumidor)
+    consumidorEsperando.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    const size_t lectura = cabeza.load(std::memory_order_relaxed);
+    bool listos = datosDisponibles.wait_for(bloqueo, std::chrono::milliseconds(timeoutMs), [&] {
+        return cola.load(std::memory_order_acquire) != lectura ||
+               cerrada.load(std::memory_order_acquire);
+    });
+
+    consumidorEsperando.store(false, std::memory_order_relaxed);
+    return listos;
+}
+
+void ColaTramasSPSC::despertarConsumidor() {
+    // Con las dos barreras, o el consumidor ve la cola nueva antes de
+    // dormirse, o el productor ve que está esperando y lo avisa con el mutex
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (consumidorEsperando.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> bloqueo(mutexEspera);
+        datosDisponibles.notify_one();
+    }
+}
+
+void ColaTramasSPSC::cerrar() {
+    cerrada.store(true, std::memory_order_release);
+    despertarConsumidor();
+}
+
+bool ColaTramasSPSC::estaCerrada() const {
+    return cerrada.load(std::memory_order_acquire);
+}
+
+unsigned long long ColaTramasSPSC::getRechazos() const {
+    return rechazos.load(std::memory_order_relaxed);
+}
+
+size_t ColaTramasSPSC::getMaximoOcupado() const {
+    return maximoOcupado.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,134 @@
+/**
+ * @file ColaTramas.h
+ * @brief Cola circular sin bloqueos entre el hilo lector y el decodificador
+ * @details Un único productor (el hilo que lee el puerto serial) y un único
+ *          consumidor (el hilo que decodifica e imprime) intercambian
+ *          tramas compactas sin mutex: cada índice lo escribe un solo hilo
+ *          y se publica con semántica release/acquire. Sólo cuando la cola
+ *          está vacía el consumidor se duerme en una variable de condición,
+ *          y el productor lo despierta al insertar.
+ */
+
+#ifndef COLA_TRAMAS_H
+#define COLA_TRAMAS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include "TramaCompacta.h"
+
+/// Tamaño de línea de caché usado para separar los índices
+#define LINEA_CACHE_COLA 64
+
+/**
+ * @class ColaTramasSPSC
+ * @brief Cola circular de un productor y un consumidor
+ * @details La capacidad se redondea a potencia de dos para indexar con una
+ *          máscara. Los índices crecen sin límite y ocupación = cola - cabeza.
+ *          Cuenta los intentos de inserción rechazados por cola llena
+ *          (contrapresión) y la ocupación máxima alcanzada.
+ */
+class ColaTramasSPSC {
+private:
+    TramaCompacta* elementos; ///< Almacenamiento circular
+    size_t mascara;           ///< capacidad - 1
+
+    /// Índice de lectura (sólo lo escribe el consumidor)
+    alignas(LINEA_CACHE_COLA) std::atomic<size_t> cabeza;
+    /// Índice de escritura (sólo lo escribe el productor)
+    alignas(LINEA_CACHE_COLA) std::atomic<size_t> cola;
+    /// Copia local del productor de la última cabeza leída
+    size_t cabezaVista;
+    /// Inserciones rechazadas por cola llena
+    std::atomic<unsigned long long> rechazos;
+    /// Mayor ocupación observada por el consumidor (sólo él la escribe)
+    std::atomic<size_t> maximoOcupado;
+    /// El productor terminó y no insertará más
+    std::atomic<bool> cerrada;
+    /// El consumidor está (o va a estar) dormido en esperarDatos
+    std::atomic<bool> consumidorEsperando;
+    /// Protege la espera del consumidor
+    std::mutex mutexEspera;
+    /// Señal de datos nuevos o de cierre
+    std::condition_variable datosDisponibles;
+
+    /**
+     * @brief Despierta al consumidor si está dormido (sólo el productor)
+     */
+    void despertarConsumidor();
+
+public:
+    /**
+     * @brief Constructor
+     * @param capacidadMinima Elementos mínimos (se redondea a potencia de dos)
+     */
+    explicit ColaTramasSPSC(size_t capacidadMinima);
+
+    /**
+     * @brief Destructor que libera el almacenamiento
+     */
+    ~ColaTramasSPSC();
+
+    ColaTramasSPSC(const ColaTramasSPSC&) = delete;
+    ColaTramasSPSC& operator=(const ColaTramasSPSC&) = delete;
+
+    /**
+     * @brief Inserta tramas (sólo desde el hilo productor)
+     * @param tramas Tramas a insertar
+     * @param n Número de tramas
+     * @return Tramas insertadas; menos de n si la cola se llenó
+     */
+    size_t insertar(const TramaCompacta* tramas, size_t n);
+
+    /**
+     * @brief Extrae tramas (sólo desde el hilo consumidor)
+     * @param destino Arreglo donde se copian las tramas
+     * @param maximo Capacidad de destino
+     * @return Tramas extraídas (0 si la cola está vacía)
+     */
+    size_t extraer(TramaCompacta* destino, size_t maximo);
+
+    /**
+     * @brief Bloquea al consumidor hasta que haya tramas o se cierre la cola
+     * @param timeoutMs Espera máxima en milisegundos
+     * @return true si hay tramas o la cola está cerrada; false si venció
+     *         la espera
+     * @details Se llama tras una extracción vacía; el productor sólo toma
+     *          el mutex para avisar cuando el consumidor está esperando
+     */
+    bool esperarDatos(int timeoutMs);
+
+    /**
+     * @brief Marca que el productor no insertará más tramas
+     */
+    void cerrar();
+
+    /**
+     * @brief Indica si el productor cerró la cola
+     * @return true si se llamó a cerrar()
+     * @details Con la cola cerrada, una extracción vacía significa que ya
+     *          se consumió todo
+     */
+    bool estaCerrada() const;
+
+    /**
+     * @brief Obtiene la capacidad real de la cola
+     * @return Número de elementos
+     */
+    size_t getCapacidad() const { return mascara + 1; }
+
+    /**
+     * @brief Obtiene el número de inserciones rechazadas por cola llena
+     * @return Contador de contrapresión
+     */
+    unsigned long long getRechazos() const;
+
+    /**
+     * @brief Obtiene la mayor ocupación alcanzada
+     * @return Marca de nivel máximo en elementos
+     */
+    size_t getMaximoOcupado() const;
+};
+
+#endif // COLA_TRAMAS_H
@@ -0,0 +1,193 @@
+/**
+ * @file DecodificadorLote.cpp
+ * @brief Implementación de la decodificación por lotes
+ */
+
+#include "DecodificadorLote.h"
+#include "ListaDeCarga.h"
+#include "RotorDeMapeo.h"
+#include "DecodificadorSIMD.h"
+#include <functional>
+#include <thread>
+
+/// Caracteres de una racha LOAD que se acumulan antes de decodificarlos
+static const int TAM_BLOQUE_SALIDA = 256;
+
+size_t decodificarLote(const TramaCompacta* tramas, size_t n,
+                       ListaDeCarga& carga, RotorDeMapeo& rotor) {
+    if (tramas == nullptr || n == 0) return 0;
+
+    const int tamano = rotor.getTamano();
+    const int inicial = rotor.getDesplazamiento();
+    int desp = inicial;
+
+    char bloque[TAM_BLOQUE_SALIDA];
+    int pendientes = 0;
+    size_t decodificados = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        const TramaCompacta& t = tramas[i];
+
+        if (t.tipo == TRAMA_LOAD) {
+            bloque[pendientes++] = (char)t.valor;
+            if (pendientes == TAM_BLOQUE_SALIDA) {
+                decodificarBloque(bloque, bloque, pendientes, rotor.getTablaMapeo(desp));
+                carga.insertarBloque(bloque, pendientes);
+                decodificados += pendientes;
+                pendientes = 0;
+            }
+        } else if (t.tipo == TRAMA_MAP && tamano > 0) {
+            // La racha LOAD termina: decodificarla con el desplazamiento vigente
+            if (pendientes > 0) {
+                decodificarBloque(bloque, bloque, pendientes, rotor.getTablaMapeo(desp));
+                carga.insertarBloque(bloque, pendientes);
+                decodificados += pendientes;
+                pendientes = 0;
+            }
+
+            // Las rotaciones se acumulan módulo el tamaño del rotor
+            int r = t.valor % tamano;
+            if (r < 0) r += tamano;
+            desp += r;
+            if (desp >= tamano) desp -= tamano;
+        }
+    }
+
+    if (pendientes > 0) {
+        decodificarBloque(bloque, bloque, pendientes, rotor.getTablaMapeo(desp));
+        carga.insertarBloque(bloque, pendientes);
+        decodificados += pendientes;
+    }
+
+    // Dejar el rotor en el mismo estado que el procesamiento secuencial
+    rotor.rotar(desp - inicial);
+
+    return decodificados;
+}
+
+/// Tramas por debajo de las cuales no compensa lanzar hilos
+static const size_t MIN_TRAMAS_PARALELO = 1 << 16;
+
+/**
+ * @struct TramoParalelo
+ * @brief Estado de un tramo de tramas asignado a un hilo
+ */
+struct TramoParalelo {
+    size_t inicio;    ///< Índice de la primera trama del tramo
+    size_t fin;       ///< Índice siguiente a la última trama
+    int rotacion;     ///< Suma de rotaciones del tramo (módulo tamaño)
+    size_t cargas;    ///< Número de tramas LOAD del tramo
+    int despInicial;  ///< Desplazamiento del rotor al inicio del tramo
+    size_t salida;    ///< Posición de su primer carácter en el búfer común
+};
+
+/**
+ * @brief Fase 1: suma las rotaciones y cuenta las cargas de un tramo
+ */
+static void resumirTramo(const TramaCompacta* tramas, int tamano, TramoParalelo& tramo) {
+    int rotacion = 0;
+    size_t cargas = 0;
+
+    for (size_t i = tramo.inicio; i < tramo.fin; i++) {
+        if (tramas[i].tipo == TRAMA_LOAD) {
+            cargas++;
+        } else if (tramas[i].tipo == TRAMA_MAP) {
+            int r = tramas[i].valor % tamano;
+            if (r < 0) r += tamano;
+            rotacion += r;
+            if (rotacion >= tamano) rotacion -= tamano;
+        }
+    }
+
+    tramo.rotacion = rotacion;
+    tramo.cargas = cargas;
+}
+
+/**
+ * @brief Fase 3: decodifica un tramo a partir de su desplazamiento inicial
+ */
+static void decodificarTramo(const TramaCompacta* tramas, const RotorDeMapeo& rotor,
+                             const TramoParalelo& tramo, char* salida) {
+    const int tamano = rotor.getTamano();
+    int desp = tramo.despInicial;
+    char* destino = salida + tramo.salida;
+    char* racha = destino;
+
+    for (size_t i = tramo.inicio; i < tramo.fin; i++) {
+        if (tramas[i].tipo == TRAMA_LOAD) {
+            *destino++ = (char)tramas[i].valor;
+        } else if (tramas[i].tipo == TRAMA_MAP) {
+            decodificarBloque(racha, racha, destino - racha, rotor.getTablaMapeo(desp));
+            racha = destino;
+
+            int r = tramas[i].valor % tamano;
+            if (r < 0) r += tamano;
+            desp += r;
+            if (desp >= tamano) desp -= tamano;
+        }
+    }
+
+    decodificarBloque(racha, racha, destino - racha, rotor.getTablaMapeo(desp));
+}
+
+size_t decodificarLoteParalelo(const TramaCompacta* tramas, size_t n,
+                               ListaDeCarga& carga, RotorDeMapeo& rotor,
+                               int numHilos) {
+    if (numHilos <= 0) {
+        numHilos = (int)std::thread::hardware_concurrency();
+    }
+    if (numHilos <= 1 || n < MIN_TRAMAS_PARALELO || rotor.getTamano() == 0) {
+        return decodificarLote(tramas, n, carga, rotor);
+    }
+
+    const int tamano = rotor.getTamano();
+    TramoParalelo* tramos = new TramoParalelo[numHilos];
+    std::thread* hilos = new std::thread[numHilos];
+
+    // Repartir las tramas en tramos contiguos de tamaño similar
+    size_t porTramo = n / numHilos;
+    for (int h = 0; h < numHilos; h++) {
+        tramos[h].inicio = h * porTramo;
+        tramos[h].fin = (h == numHilos - 1) ? n : (h + 1) * porTramo;
+    }
+
+    // Fase 1: resumen de cada tramo en paralelo
+    for (int h = 0; h < numHilos; h++) {
+        hilos[h] = std::thread(resumirTramo, tramas, tamano, std::ref(tramos[h]));
+    }
+    for (int h = 0; h < numHilos; h++) {
+        hilos[h].join();
+    }
+
+    // Fase 2: barrido exclusivo de rotaciones y de posiciones de salida
+    int desp = rotor.getDesplazamiento();
+    size_t total = 0;
+    for (int h = 0; h < numHilos; h++) {
+        tramos[h].despInicial = desp;
+        tramos[h].salida = total;
+        desp += tramos[h].rotacion;
+        if (desp >= tamano) desp -= tamano;
+        total += tramos[h].cargas;
+    }
+
+    // Fase 3: cada hilo decodifica su tramo en su parte del búfer común
+    char* salida = new char[total > 0 ? total : 1];
+    for (int h = 0; h < numHilos; h++) {
+        hilos[h] = std::thread(decodificarTramo, tramas, std::cref(rotor),
+                               std::cref(tramos[h]), salida);
+    }
+    for (int h = 0; h < numHilos; h++) {
+        hilos[h].join();
+    }
+
+    // Unir los tramos en orden
+    carga.insertarBloque(salida, total);
+
+    rotor.rotar(desp - rotor.getDesplazamiento());
+
+    delete[] salida;
+    delete[] hilos;
+    delete[] tramos;
+
+    return total;
+}
@@ -0,0 +1,52 @@
+/**
+ * @file DecodificadorLote.h
+ * @brief Decodificación por lotes de tramas PRT-7
+ * @details Procesa un arreglo completo de tramas compactas en un solo bucle,
+ *          sin objetos en el heap ni despacho virtual
+ */
+
+#ifndef DECODIFICADOR_LOTE_H
+#define DECODIFICADOR_LOTE_H
+
+#include <cstddef>
+#include "TramaCompacta.h"
+
+class ListaDeCarga;
+class RotorDeMapeo;
+
+/**
+ * @brief Decodifica un arreglo de tramas en orden
+ * @param tramas Arreglo de tramas compactas
+ * @param n Número de tramas del arreglo
+ * @param carga Lista donde se insertan los caracteres decodificados
+ * @param rotor Rotor de mapeo; al terminar queda rotado igual que si se
+ *              hubieran procesado las tramas una a una
+ * @return Número de caracteres decodificados
+ * @details Lleva el desplazamiento del rotor en una variable local y sólo
+ *          lo aplica al rotor al final del lote
+ */
+size_t decodificarLote(const TramaCompacta* tramas, size_t n,
+                       ListaDeCarga& carga, RotorDeMapeo& rotor);
+
+/**
+ * @brief Decodifica un arreglo grande de tramas repartiéndolo entre hilos
+ * @param tramas Arreglo de tramas compactas
+ * @param n Número de tramas del arreglo
+ * @param carga Lista donde se insertan los caracteres decodificados, en orden
+ * @param rotor Rotor de mapeo; al terminar queda rotado igual que con
+ *              decodificarLote
+ * @param numHilos Hilos a usar (0 = número de núcleos disponibles)
+ * @return Número de caracteres decodificados
+ * @details Las rotaciones MAP se componen sumándose módulo el tamaño del
+ *          rotor, así que el estado al inicio de cada tramo es la suma
+ *          prefija exclusiva de las rotaciones de los tramos anteriores.
+ *          Primero cada hilo suma las rotaciones de su tramo, después se
+ *          hace el barrido exclusivo y por último cada hilo decodifica su
+ *          tramo de forma independiente. Para lotes pequeños se usa
+ *          directamente decodificarLote.
+ */
+size_t decodificarLoteParalelo(const TramaCompacta* tramas, size_t n,
+                               ListaDeCarga& carga, RotorDeMapeo& rotor,
+                               int numHilos = 0);
+
+#endif // DECODIFICADOR_LOTE_H
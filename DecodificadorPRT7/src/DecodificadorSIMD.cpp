@@ -0,0 +1,170 @@
+/**
+ * @file DecodificadorSIMD.cpp
+ * @brief Implementación de los kernels de decodificación por bloques
+ */
+
+#include "DecodificadorSIMD.h"
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define PRT7_KERNELS_X86 1
+    #include <immintrin.h>
+#endif
+
+void decodificarBloqueEscalar(const char* entrada, char* salida, size_t n,
+                              const unsigned char* tabla) {
+    const unsigned char* in = (const unsigned char*)entrada;
+    size_t i = 0;
+
+    // Desenrollado x4 para ocultar la latencia de las cargas de la tabla
+    for (; i + 4 <= n; i += 4) {
+        unsigned char a = tabla[in[i]];
+        unsigned char b = tabla[in[i + 1]];
+        unsigned char c = tabla[in[i + 2]];
+        unsigned char d = tabla[in[i + 3]];
+        salida[i] = (char)a;
+        salida[i + 1] = (char)b;
+        salida[i + 2] = (char)c;
+        salida[i + 3] = (char)d;
+    }
+    for (; i < n; i++) {
+        salida[i] = (char)tabla[in[i]];
+    }
+}
+
+#ifdef PRT7_KERNELS_X86
+
+/*
+ * Búsqueda en una tabla de 256 bytes con pshufb: la tabla se ve como 16
+ * subtablas de 16 bytes. El nibble bajo de cada byte indexa la subtabla con
+ * pshufb y el nibble alto selecciona cuál de las 16 se queda.
+ */
+
+__attribute__((target("ssse3")))
+static void decodificarBloqueSSSE3(const char* entrada, char* salida, size_t n,
+                                   const unsigned char* tabla) {
+    __m128i subtablas[16];
+    for (int h = 0; h < 16; h++) {
+        subtablas[h] = _mm_loadu_si128((const __m128i*)(tabla + h * 16));
+    }
+
+    const __m128i mascaraBaja = _mm_set1_epi8(0x0F);
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(entrada + i));
+        __m128i bajo = _mm_and_si128(v, mascaraBaja);
+        __m128i alto = _mm_and_si128(_mm_srli_epi16(v, 4), mascaraBaja);
+        __m128i res = _mm_setzero_si128();
+
+        for (int h = 0; h < 16; h++) {
+            __m128i sel = _mm_cmpeq_epi8(alto, _mm_set1_epi8((char)h));
+            __m128i val = _mm_shuffle_epi8(subtablas[h], bajo);
+            res = _mm_or_si128(res, _mm_and_si128(sel, val));
+        }
+
+        _mm_storeu_si128((__m128i*)(salida + i), res);
+    }
+
+    decodificarBloqueEscalar(entrada + i, salida + i, n - i, tabla);
+}
+
+__attribute__((target("avx2")))
+static void decodificarBloqueAVX2(const char* entrada, char* salida, size_t n,
+                                  const unsigned char* tabla) {
+    // vpshufb opera por carril de 128 bits: replicar cada subtabla en ambos
+    __m256i subtablas[16];
+    for (int h = 0; h < 16; h++) {
+        __m128i t = _mm_loadu_si128((const __m128i*)(tabla + h * 16));
+        subtablas[h] = _mm256_broadcastsi128_si256(t);
+    }
+
+    const __m256i mascaraBaja = _mm256_set1_epi8(0x0F);
+    size_t i = 0;
+
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(entrada + i));
+        __m256i bajo = _mm256_and_si256(v, mascaraBaja);
+        __m256i alto = _mm256_and_si256(_mm256_srli_epi16(v, 4), mascaraBaja);
+        __m256i res = _mm256_setzero_si256();
+
+        for (int h = 0; h < 16; h++) {
+            __m256i sel = _mm256_cmpeq_epi8(alto, _mm256_set1_epi8((char)h));
+            __m256i val = _mm256_shuffle_epi8(subtablas[h], bajo);
+            res = _mm256_or_si256(res, _mm256_and_si256(sel, val));
+        }
+
+        _mm256_storeu_si256((__m256i*)(salida + i), res);
+    }
+
+    decodificarBloqueEscalar(entrada + i, salida + i, n - i, tabla);
+}
+
+#endif // PRT7_KERNELS_X86
+
+/**
+ * @struct KernelElegido
+ * @brief Kernel adecuado para la CPU actual y su nombre
+ */
+struct KernelElegido {
+    KernelDecodificacion funcion;
+    const char* nombre;
+};
+
+/**
+ * @brief Detecta el kernel adecuado para la CPU actual
+ */
+static KernelElegido elegirKernel() {
+    KernelElegido k;
+#ifdef PRT7_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        k.funcion = decodificarBloqueAVX2;
+        k.nombre = "avx2";
+        return k;
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        k.funcion = decodificarBloqueSSSE3;
+        k.nombre = "ssse3";
+        return k;
+    }
+#endif
+    k.funcion = decodificarBloqueEscalar;
+    k.nombre = "escalar";
+    return k;
+}
+
+/**
+ * @brief Kernel elegido, detectado en la primera llamada
+ * @details Estático local en vez de global: así también es válido cuando se
+ *          decodifica desde el inicializador estático de otro archivo.
+ */
+static const KernelElegido& kernelActivo() {
+    static const KernelElegido elegido = elegirKernel();
+    return elegido;
+}
+
+void decodificarBloque(const char* entrada, char* salida, size_t n,
+                       const unsigned char* tabla) {
+    kernelActivo().funcion(entrada, salida, n, tabla);
+}
+
+const char* nombreKernelDecodificacion() {
+    return kernelActivo().nombre;
+}
+
+KernelDecodificacion buscarKernelDecodificacion(const char* nombre) {
+    if (strcmp(nombre, "escalar") == 0) {
+        return decodificarBloqueEscalar;
+    }
+#ifdef PRT7_KERNELS_X86
+    __builtin_cpu_init();
+    if (strcmp(nombre, "avx2") == 0 && __builtin_cpu_supports("avx2")) {
+        return decodificarBloqueAVX2;
+    }
+    if (strcmp(nombre, "ssse3") == 0 && __builtin_cpu_supports("ssse3")) {
+        return decodificarBloqueSSSE3;
+    }
+#endif
+    return nullptr;
+}
@@ -0,0 +1,53 @@
+/**
+ * @file DecodificadorSIMD.h
+ * @brief Kernels vectorizados para decodificar rachas de tramas LOAD
+ * @details Entre dos tramas MAP el desplazamiento del rotor no cambia, así que
+ *          cada LOAD es una sustitución byte a byte mediante una tabla de 256
+ *          entradas. Estos kernels aplican esa tabla a bloques contiguos.
+ */
+
+#ifndef DECODIFICADOR_SIMD_H
+#define DECODIFICADOR_SIMD_H
+
+#include <cstddef>
+
+/// Firma común de los kernels de decodificación
+typedef void (*KernelDecodificacion)(const char*, char*, size_t, const unsigned char*);
+
+/**
+ * @brief Decodifica un bloque contiguo de caracteres con una tabla de mapeo
+ * @param entrada Caracteres recibidos en tramas LOAD
+ * @param salida Destino de los caracteres decodificados (puede ser == entrada)
+ * @param n Número de caracteres
+ * @param tabla Tabla de 256 bytes (ver RotorDeMapeo::getTablaMapeo)
+ * @details Elige en tiempo de ejecución el mejor kernel disponible
+ *          (AVX2, SSSE3 o escalar). El resultado es idéntico en todos.
+ */
+void decodificarBloque(const char* entrada, char* salida, size_t n,
+                       const unsigned char* tabla);
+
+/**
+ * @brief Versión escalar de decodificarBloque
+ * @param entrada Caracteres recibidos en tramas LOAD
+ * @param salida Destino de los caracteres decodificados
+ * @param n Número de caracteres
+ * @param tabla Tabla de 256 bytes
+ */
+void decodificarBloqueEscalar(const char* entrada, char* salida, size_t n,
+                              const unsigned char* tabla);
+
+/**
+ * @brief Nombre del kernel elegido por decodificarBloque
+ * @return "avx2", "ssse3" o "escalar"
+ */
+const char* nombreKernelDecodificacion();
+
+/**
+ * @brief Busca un kernel concreto por nombre
+ * @param nombre "avx2", "ssse3" o "escalar"
+ * @return El kernel, o nullptr si no se compiló o la CPU no lo soporta
+ * @details Pensado para pruebas y benchmarks que comparan los kernels entre sí.
+ */
+KernelDecodificacion buscarKernelDecodificacion(const char* nombre);
+
+#endif // DECODIFICADOR_SIMD_H
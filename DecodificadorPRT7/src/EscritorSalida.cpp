@@ -0,0 +1,87 @@
+/**
+ * @file EscritorSalida.cpp
+ * @brief Implementación del escritor con búfer
+ */
+
+#include "EscritorSalida.h"
+#include <cstdarg>
+
+EscritorSalida::EscritorSalida(FILE* destino, size_t capacidad)
+    : destino(destino), buffer(new char[capacidad]), capacidad(capacidad),
+      usado(0), error(false) {
+}
+
+EscritorSalida::~EscritorSalida() {
+    vaciar();
+    delete[] buffer;
+}
+
+void EscritorSalida::escribirGrande(const char* datos, size_t n) {
+    vaciar();
+    if (n < capacidad) {
+        memcpy(buffer, datos, n);
+        usado = n;
+    } else if (fwrite(datos, 1, n, destino) != n) {
+        // Más grande que el búfer: copiarlo sería un paso extra
+        error = true;
+    }
+}
+
+void EscritorSalida::escribirFormato(const char* formato, ...) {
+    va_list args;
+    va_start(args, formato);
+    int n = vsnprintf(buffer + usado, capacidad - usado, formato, args);
+    va_end(args);
+
+    if (n < 0) {
+        error = true;
+        return;
+    }
+
+    if ((size_t)n >= capacidad - usado) {
+        // No cupo: vaciar y volver a formatear desde el inicio del búfer
+        vaciar();
+        if ((size_t)n >= capacidad) {
+            char* temporal = new char[n + 1];
+            va_start(args, formato);
+            vsnprintf(temporal, n + 1, formato, args);
+            va_end(args);
+            escribirGrande(temporal, n);
+            delete[] temporal;
+            return;
+        }
+        va_start(args, formato);
+        vsnprintf(buffer, capacidad, formato, args);
+        va_end(args);
+    }
+    usado += n;
+}
+
+void EscritorSalida::escribirJSON(const char* datos, size_t n) {
+    static const char HEX[] = "0123456789abcdef";
+
+    for (size_t i = 0; i < n; i++) {
+        unsigned char c = (unsigned char)datos[i];
+        if (c == '"' || c == '\\') {
+            escribirCaracter('\\');
+            escribirCaracter((char)c);
+        } else if (c < 0x20 || c >= 0x80) {
+            // Los bytes altos se emiten como el punto de código Latin-1 del
+            // mismo valor: sueltos no serían UTF-8 válido
+            char escape[6] = { '\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xF] };
+            escribir(escape, sizeof(escape));
+        } else {
+            escribirCaracter((char)c);
+        }
+    }
+}
+
+bool EscritorSalida::vaciar() {
+    if (usado > 0) {
+        if (fwrite(buffer, 1, usado, destino) != usado) {
+            error = true;
+        }
+        usado = 0;
+    }
+    return !error;
+}
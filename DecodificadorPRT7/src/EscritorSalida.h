@@ -0,0 +1,134 @@
+/**
+ * @file EscritorSalida.h
+ * @brief Escritor con búfer grande para volcar mensajes y registros
+ * @details Acumula la salida en memoria y la entrega con un solo fwrite por
+ *          vaciado, en lugar de un printf (y un bloqueo de stdio) por
+ *          carácter. Lo usan ListaDeCarga, RotorDeMapeo y el registro NDJSON
+ *          de tramas.
+ */
+
+#ifndef ESCRITOR_SALIDA_H
+#define ESCRITOR_SALIDA_H
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+/// Capacidad por defecto del búfer de salida
+#define TAM_BUFFER_SALIDA (256 * 1024)
+
+/// Capacidad para escritores de consola que se vacían tras cada mensaje
+#define TAM_BUFFER_CONSOLA (4 * 1024)
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define PRT7_FORMATO_PRINTF(fmt, args) __attribute__((format(printf, fmt, args)))
+#else
+    #define PRT7_FORMATO_PRINTF(fmt, args)
+#endif
+
+/**
+ * @enum FormatoSalida
+ * @brief Formatos en que se puede volcar el mensaje y el estado del rotor
+ */
+enum FormatoSalida {
+    SALIDA_CRUDA = 0,  ///< Caracteres tal cual ("HOLA")
+    SALIDA_CORCHETES,  ///< Un carácter por par de corchetes ("[H][O][L][A]")
+    SALIDA_NDJSON      ///< Un objeto JSON por línea
+};
+
+/**
+ * @class EscritorSalida
+ * @brief Búfer de escritura sobre un FILE*
+ * @details No es seguro entre hilos. Quien mezcle este escritor con printf
+ *          sobre el mismo FILE* debe llamar a vaciar() antes de cada printf
+ *          para conservar el orden.
+ */
+class EscritorSalida {
+private:
+    FILE* destino;    ///< Flujo donde se vuelca el búfer
+    char* buffer;     ///< Datos pendientes
+    size_t capacidad; ///< Tamaño del búfer
+    size_t usado;     ///< Bytes pendientes en el búfer
+    bool error;       ///< Algún fwrite escribió menos de lo pedido
+
+    /**
+     * @brief Escribe directamente en destino datos que no caben en el búfer
+     */
+    void escribirGrande(const char* datos, size_t n);
+
+public:
+    /**
+     * @brief Constructor
+     * @param destino Flujo de salida (stdout, un archivo abierto, ...)
+     * @param capacidad Tamaño del búfer en bytes
+     */
+    explicit EscritorSalida(FILE* destino, size_t capacidad = TAM_BUFFER_SALIDA);
+
+    /**
+     * @brief Destructor: vacía lo pendiente y libera el búfer
+     */
+    ~EscritorSalida();
+
+    EscritorSalida(const EscritorSalida&) = delete;
+    EscritorSalida& operator=(const EscritorSalida&) = delete;
+
+    /**
+     * @brief Agrega bytes a la salida
+     * @param datos Bytes a escribir
+     * @param n Número de bytes
+     */
+    void escribir(const char* datos, size_t n) {
+        if (n <= capacidad - usado) {
+            memcpy(buffer + usado, datos, n);
+            usado += n;
+        } else {
+            escribirGrande(datos, n);
+        }
+    }
+
+    /**
+     * @brief Agrega un carácter a la salida
+     * @param c Carácter a escribir
+     */
+    void escribirCaracter(char c) {
+        if (usado == capacidad) {
+            vaciar();
+        }
+        buffer[usado++] = c;
+    }
+
+    /**
+     * @brief Agrega una cadena terminada en '\0'
+     * @param texto Cadena a escribir
+     */
+    void escribirCadena(const char* texto) { escribir(texto, strlen(texto)); }
+
+    /**
+     * @brief Agrega texto con formato printf
+     * @param formato Cadena de formato
+     */
+    void escribirFormato(const char* formato, ...) PRT7_FORMATO_PRINTF(2, 3);
+
+    /**
+     * @brief Agrega bytes escapados para ir dentro de una cadena JSON
+     * @param datos Bytes a escapar (sin las comillas)
+     * @param n Número de bytes
+     * @details Los bytes de control y los >= 0x80 se escriben como \u00XX,
+     *          así la salida es siempre ASCII (y por tanto UTF-8 válido)
+     */
+    void escribirJSON(const char* datos, size_t n);
+
+    /**
+     * @brief Entrega lo pendiente al flujo con un solo fwrite
+     * @return false si hubo algún error de escritura desde la creación
+     */
+    bool vaciar();
+
+    /**
+     * @brief Obtiene el flujo de destino
+     * @return FILE* recibido en el constructor
+     */
+    FILE* getDestino() const { return destino; }
+};
+
+#endif // ESCRITOR_SALIDA_H
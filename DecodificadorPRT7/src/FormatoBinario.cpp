@@ -0,0 +1,437 @@
+/**
+ * @file FormatoBinario.cpp
+ * @brief Implementación del formato binario de capturas PRT-7
+ */
+
+#include "FormatoBinario.h"
+#include "ListaDeCarga.h"
+#include "RotorDeMapeo.h"
+#include "DecodificadorSIMD.h"
+#include <cstring>
+#include <thread>
+
+/// Firma al inicio de toda captura binaria
+static const char FIRMA_BINARIO[4] = { 'P', 'R', 'T', '7' };
+
+/// Etiqueta de racha LOAD con longitud en varint
+static const unsigned char ETIQUETA_RACHA_LARGA = 0x80;
+
+/// Etiqueta de trama MAP
+static const unsigned char ETIQUETA_MAP = 0x81;
+
+/// Capacidad inicial del búfer de racha del escritor
+static const size_t CAPACIDAD_RACHA_INICIAL = 4096;
+
+/// Racha más larga que el escritor acumula en memoria antes de escribirla
+static const size_t CAPACIDAD_RACHA_MAXIMA = 1 << 20;
+
+/// Caracteres que el cargador decodifica de una vez
+static const size_t TAM_BLOQUE_CARGADOR = 4096;
+
+/// Caracteres por ventana del cargador paralelo (tamaño del búfer intermedio)
+static const size_t TAM_VENTANA_PARALELA = 1 << 24;
+
+/// Segmentos por ventana del cargador paralelo (acota las capturas de rachas cortas)
+static const size_t MAX_SEGMENTOS_VENTANA = 1 << 18;
+
+/// Caracteres por hilo por debajo de los cuales no compensa lanzar otro
+static const size_t MIN_CARACTERES_HILO = 1 << 18;
+
+/**
+ * @brief Codifica la cabecera del formato
+ */
+static void armarCabecera(unsigned char* cabecera, unsigned long long tramas) {
+    memcpy(cabecera, FIRMA_BINARIO, 4);
+    cabecera[4] = VERSION_BINARIO_PRT7;
+    cabecera[5] = cabecera[6] = cabecera[7] = 0;
+    for (int i = 0; i < 8; i++) {
+        cabecera[8 + i] = (unsigned char)(tramas >> (8 * i));
+    }
+}
+
+// ============ ESCRITOR ============
+
+EscritorBinarioPRT7::EscritorBinarioPRT7(FILE* archivo)
+    : salida(archivo), racha(new char[CAPACIDAD_RACHA_INICIAL]), pendientes(0),
+      capacidadRacha(CAPACIDAD_RACHA_INICIAL), tramas(0), error(false) {
+    unsigned char cabecera[TAM_CABECERA_BINARIO_PRT7];
+    armarCabecera(cabecera, 0);
+    if (fwrite(cabecera, 1, sizeof(cabecera), salida) != sizeof(cabecera)) {
+        error = true;
+    }
+}
+
+EscritorBinarioPRT7::~EscritorBinarioPRT7() {
+    delete[] racha;
+}
+
+void EscritorBinarioPRT7::escribirVarint(unsigned long long valor) {
+    unsigned char bytes[10];
+    int n = 0;
+    do {
+        unsigned char b = valor & 0x7F;
+        valor >>= 7;
+        bytes[n++] = valor ? (b | 0x80) : b;
+    } while (valor);
+
+    if (fwrite(bytes, 1, n, salida) != (size_t)n) {
+        error = true;
+    }
+}
+
+void EscritorBinarioPRT7::vaciarRacha() {
+    if (pendientes == 0) return;
+
+    if (pendientes <= MAX_RACHA_CORTA_PRT7) {
+        unsigned char etiqueta = (unsigned char)(pendientes - 1);
+        if (fputc(etiqueta, salida) == EOF) error = true;
+    } else {
+        if (fputc(ETIQUETA_RACHA_LARGA, salida) == EOF) error = true;
+        escribirVarint(pendientes);
+    }
+
+    if (fwrite(racha, 1, pendientes, salida) != pendientes) {
+        error = true;
+    }
+    pendientes = 0;
+}
+
+void EscritorBinarioPRT7::agregarLoad(char c) {
+    agregarLoads(&c, 1);
+}
+
+void EscritorBinarioPRT7::agregarLoads(const char* datos, size_t n) {
+    tramas += n;
+
+    // Una racha muy larga se parte en varias seguidas (el cargador las
+    // encadena), para que el búfer no crezca con la captura
+    while (pendientes + n > CAPACIDAD_RACHA_MAXIMA) {
+        size_t trozo = CAPACIDAD_RACHA_MAXIMA - pendientes;
+        copiarARacha(datos, trozo);
+        vaciarRacha();
+        datos += trozo;
+        n -= trozo;
+    }
+    copiarARacha(datos, n);
+}
+
+void EscritorBinarioPRT7::copiarARacha(const char* datos, size_t n) {
+    if (pendientes + n > capacidadRacha) {
+        // Duplicar hasta que quepa; la racha se escribe entera al final
+        size_t nueva = capacidadRacha;
+        while (pendientes + n > nueva) nueva *= 2;
+        char* mayor = new char[nueva];
+        memcpy(mayor, racha, pendientes);
+        delete[] racha;
+        racha = mayor;
+        capacidadRacha = nueva;
+    }
+
+    memcpy(racha + pendientes, datos, n);
+    pendientes += n;
+}
+
+void EscritorBinarioPRT7::agregarMap(int rotacion) {
+    vaciarRacha();
+
+    if (fputc(ETIQUETA_MAP, salida) == EOF) error = true;
+
+    // Zigzag: los valores negativos pequeños ocupan pocos bytes
+    long long v = rotacion;
+    unsigned long long zigzag = ((unsigned long long)v << 1) ^ (unsigned long long)(v >> 63);
+    escribirVarint(zigzag);
+
+    tramas++;
+}
+
+bool EscritorBinarioPRT7::terminar() {
+    vaciarRacha();
+
+    unsigned char cabecera[TAM_CABECERA_BINARIO_PRT7];
+    armarCabecera(cabecera, tramas);
+
+    if (fseek(salida, 0, SEEK_SET) != 0 ||
+        fwrite(cabecera, 1, sizeof(cabecera), salida) != sizeof(cabecera) ||
+        fseek(salida, 0, SEEK_END) != 0 ||
+        fflush(salida) != 0) {
+        error = true;
+    }
+
+    return !error;
+}
+
+// ============ CARGADOR ============
+
+bool esCapturaBinaria(const char* datos, size_t tamano) {
+    return tamano >= TAM_CABECERA_BINARIO_PRT7 && memcmp(datos, FIRMA_BINARIO, 4) == 0;
+}
+
+/**
+ * @brief Lee un varint con control de límites
+ * @return false si los datos terminan antes o el valor es demasiado largo
+ */
+static bool leerVarint(const unsigned char*& p, const unsigned char* fin,
+                       unsigned long long& valor) {
+    valor = 0;
+    for (int desplazamiento = 0; desplazamiento < 64; desplazamiento += 7) {
+        if (p == fin) return false;
+        unsigned char b = *p++;
+        valor |= (unsigned long long)(b & 0x7F) << desplazamiento;
+        if ((b & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+/**
+ * @enum TipoRegistro
+ * @brief Clase de registro leída por leerRegistro
+ */
+enum TipoRegistro {
+    REGISTRO_LOAD,     ///< Racha LOAD; sus caracteres siguen en la captura
+    REGISTRO_MAP,      ///< Trama MAP
+    REGISTRO_INVALIDO  ///< Etiqueta desconocida o datos truncados
+};
+
+/**
+ * @brief Lee la etiqueta y la longitud o rotación de un registro
+ * @param p Inicio del registro; queda en el primer carácter de la racha
+ *          o en el registro siguiente
+ * @param fin Fin de la captura
+ * @param tamanoRotor Tamaño del rotor para reducir la rotación
+ * @param largo Salida: caracteres de la racha LOAD (ya verificados)
+ * @param rotacion Salida: rotación MAP en [0, tamanoRotor)
+ */
+static TipoRegistro leerRegistro(const unsigned char*& p, const unsigned char* fin,
+                                 int tamanoRotor, unsigned long long& largo, int& rotacion) {
+    unsigned char etiqueta = *p++;
+
+    if (etiqueta == ETIQUETA_MAP) {
+        unsigned long long zigzag;
+        if (!leerVarint(p, fin, zigzag)) return REGISTRO_INVALIDO;
+        long long valor = (long long)(zigzag >> 1) ^ -(long long)(zigzag & 1);
+
+        rotacion = 0;
+        if (tamanoRotor > 0) {
+            rotacion = (int)(valor % tamanoRotor);
+            if (rotacion < 0) rotacion += tamanoRotor;
+        }
+        return REGISTRO_MAP;
+    }
+
+    if (etiqueta < ETIQUETA_RACHA_LARGA) {
+        largo = etiqueta + 1ULL;
+    } else if (etiqueta != ETIQUETA_RACHA_LARGA || !leerVarint(p, fin, largo)) {
+        return REGISTRO_INVALIDO;
+    }
+
+    if (largo > (unsigned long long)(fin - p)) return REGISTRO_INVALIDO;
+    return REGISTRO_LOAD;
+}
+
+/**
+ * @brief Avanza un desplazamiento del rotor con una rotación ya reducida
+ */
+static inline void avanzarDesplazamiento(int& desp, int rotacion, int tamanoRotor) {
+    desp += rotacion;
+    if (desp >= tamanoRotor) desp -= tamanoRotor;
+}
+
+/**
+ * @brief Decodifica una captura de principio a fin en el hilo llamador
+ */
+static bool decodificarSecuencial(const unsigned char* p, const unsigned char* fin,
+                                  ListaDeCarga& carga, RotorDeMapeo& rotor,
+                                  unsigned long long& tramas) {
+    const int tamanoRotor = rotor.getTamano();
+    const int inicial = rotor.getDesplazamiento();
+    int desp = inicial;
+
+    char bloque[TAM_BLOQUE_CARGADOR];
+    bool valida = true;
+
+    while (p < fin) {
+        unsigned long long largo;
+        int rotacion;
+        TipoRegistro tipo = leerRegistro(p, fin, tamanoRotor, largo, rotacion);
+
+        if (tipo == REGISTRO_INVALIDO) {
+            valida = false;
+            break;
+        }
+        if (tipo == REGISTRO_MAP) {
+            avanzarDesplazamiento(desp, rotacion, tamanoRotor);
+            tramas++;
+            continue;
+        }
+
+        // Racha LOAD: decodificar directamente desde los datos de entrada
+        const unsigned char* tabla = rotor.getTablaMapeo(desp);
+        while (largo > 0) {
+            size_t trozo = largo < TAM_BLOQUE_CARGADOR ? (size_t)largo : TAM_BLOQUE_CARGADOR;
+            decodificarBloque((const char*)p, bloque, trozo, tabla);
+            carga.insertarBloque(bloque, trozo);
+            p += trozo;
+            largo -= trozo;
+            tramas += trozo;
+        }
+    }
+
+    rotor.rotar(desp - inicial);
+    return valida;
+}
+
+/**
+ * @struct SegmentoCarga
+ * @brief Tramo de una racha LOAD asignado a una ventana del cargador paralelo
+ */
+struct SegmentoCarga {
+    const char* origen; ///< Caracteres recibidos, dentro de la captura
+    size_t largo;       ///< Número de caracteres
+    int desp;           ///< Desplazamiento del rotor durante la racha
+    size_t salida;      ///< Posición del primer carácter dentro de la ventana
+};
+
+/**
+ * @brief Decodifica la parte [desde, hasta) de una ventana
+ * @details Cada hilo escribe sólo en su rango de salida; los segmentos que
+ *          cruzan un límite se reparten entre los dos hilos
+ */
+static void decodificarSegmentos(const SegmentoCarga* segmentos, size_t n,
+                                 size_t desde, size_t hasta,
+                                 const RotorDeMapeo& rotor, char* salida) {
+    // Primer segmento que termina después de desde
+    size_t bajo = 0;
+    size_t alto = n;
+    while (bajo < alto) {
+        size_t medio = bajo + (alto - bajo) / 2;
+        if (segmentos[medio].salida + segmentos[medio].largo <= desde) {
+            bajo = medio + 1;
+        } else {
+            alto = medio;
+        }
+    }
+
+    for (size_t i = bajo; i < n && segmentos[i].salida < hasta; i++) {
+        const SegmentoCarga& s = segmentos[i];
+        size_t a = s.salida > desde ? s.salida : desde;
+        size_t b = s.salida + s.largo < hasta ? s.salida + s.largo : hasta;
+        decodificarBloque(s.origen + (a - s.salida), salida + a, b - a,
+                          rotor.getTablaMapeo(s.desp));
+    }
+}
+
+/**
+ * @brief Decodifica una captura por ventanas repartiendo cada una entre hilos
+ * @details Un recorrido secuencial de las etiquetas (sin tocar los
+ *          caracteres) asigna a cada racha su desplazamiento y su posición
+ *          de salida; después los hilos decodifican rangos disjuntos de la
+ *          ventana y se inserta de una vez. La memoria extra está acotada
+ *          por TAM_VENTANA_PARALELA y MAX_SEGMENTOS_VENTANA.
+ */
+static bool decodificarParalelo(const unsigned char* p, const unsigned char* fin,
+                                ListaDeCarga& carga, RotorDeMapeo& rotor,
+                                unsigned long long& tramas, int numHilos) {
+    const int tamanoRotor = rotor.getTamano();
+    const int inicial = rotor.getDesplazamiento();
+    int desp = inicial;
+
+    SegmentoCarga* segmentos = new SegmentoCarga[MAX_SEGMENTOS_VENTANA];
+    char* ventana = new char[TAM_VENTANA_PARALELA];
+    std::thread* hilos = new std::thread[numHilos];
+
+    bool valida = true;
+    unsigned long long restante = 0; // Caracteres de la racha en curso sin asignar
+
+    while (valida && (p < fin || restante > 0)) {
+        // Fase 1: asignar rachas a la ventana hasta llenarla
+        size_t n = 0;
+        size_t total = 0;
+        while (n < MAX_SEGMENTOS_VENTANA && total < TAM_VENTANA_PARALELA) {
+            if (restante == 0) {
+                if (p >= fin) break;
+
+                int rotacion;
+                TipoRegistro tipo = leerRegistro(p, fin, tamanoRotor, restante, rotacion);
+                if (tipo == REGISTRO_INVALIDO) {
+                    restante = 0;
+                    valida = false;
+                    break;
+                }
+                if (tipo == REGISTRO_MAP) {
+                    restante = 0;
+                    avanzarDesplazamiento(desp, rotacion, tamanoRotor);
+                    tramas++;
+                    continue;
+                }
+                if (restante == 0) continue;
+            }
+
+            size_t libres = TAM_VENTANA_PARALELA - total;
+            size_t trozo = restante < libres ? (size_t)restante : libres;
+            segmentos[n].origen = (const char*)p;
+            segmentos[n].largo = trozo;
+            segmentos[n].desp = desp;
+            segmentos[n].salida = total;
+            n++;
+
+            p += trozo;
+            restante -= trozo;
+            total += trozo;
+            tramas += trozo;
+        }
+
+        if (total == 0) continue;
+
+        // Fase 2: rangos de salida disjuntos, uno por hilo
+        size_t usados = total / MIN_CARACTERES_HILO;
+        if (usados > (size_t)numHilos) usados = numHilos;
+        if (usados <= 1) {
+            decodificarSegmentos(segmentos, n, 0, total, rotor, ventana);
+        } else {
+            for (size_t h = 0; h < usados; h++) {
+                hilos[h] = std::thread(decodificarSegmentos, segmentos, n,
+                                       total * h / usados, total * (h + 1) / usados,
+                                       std::cref(rotor), ventana);
+            }
+            for (size_t h = 0; h < usados; h++) {
+                hilos[h].join();
+            }
+        }
+
+        carga.insertarBloque(ventana, total);
+    }
+
+    rotor.rotar(desp - inicial);
+
+    delete[] hilos;
+    delete[] ventana;
+    delete[] segmentos;
+    return valida;
+}
+
+bool decodificarCapturaBinaria(const char* datos, size_t tamano,
+                               ListaDeCarga& carga, RotorDeMapeo& rotor,
+                               unsigned long long& tramas, int numHilos) {
+    tramas = 0;
+    if (!esCapturaBinaria(datos, tamano) || (unsigned char)datos[4] != VERSION_BINARIO_PRT7) {
+        return false;
+    }
+
+    const unsigned char* p = (const unsigned char*)datos + TAM_CABECERA_BINARIO_PRT7;
+    const unsigned char* fin = (const unsigned char*)datos + tamano;
+
+    if (numHilos <= 0) {
+        numHilos = (int)std::thread::hardware_concurrency();
+    }
+
+    bool valida = numHilos > 1 && tamano >= 2 * MIN_CARACTERES_HILO
+                  ? decodificarParalelo(p, fin, carga, rotor, tramas, numHilos)
+                  : decodificarSecuencial(p, fin, carga, rotor, tramas);
+
+    // El conteo de la cabecera debe coincidir con lo decodificado
+    unsigned long long declaradas = 0;
+    for (int i = 0; i < 8; i++) {
+        declaradas |= (unsigned long long)(unsigned char)datos[8 + i] << (8 * i);
+    }
+    return valida && declaradas == tramas;
+}
@@ -0,0 +1,150 @@
+/**
+ * @file FormatoBinario.h
+ * @brief Formato binario compacto para capturas PRT-7
+ * @details Estructura del archivo (enteros en little-endian):
+ *
+ *          Cabecera de 16 bytes:
+ *            - 4 bytes: firma "PRT7"
+ *            - 1 byte:  versión (VERSION_BINARIO_PRT7)
+ *            - 3 bytes: reservados (0)
+ *            - 8 bytes: número total de tramas
+ *
+ *          Registros, uno tras otro:
+ *            - 0x00-0x7F: racha de (etiqueta + 1) tramas LOAD; siguen sus
+ *                         caracteres en crudo
+ *            - 0x80:      racha LOAD larga; siguen su longitud en varint
+ *                         y los caracteres en crudo
+ *            - 0x81:      trama MAP; sigue la rotación en varint zigzag
+ *
+ *          Las rachas LOAD quedan contiguas en el archivo, así que el
+ *          cargador las decodifica directamente con decodificarBloque.
+ */
+
+#ifndef FORMATO_BINARIO_H
+#define FORMATO_BINARIO_H
+
+#include <cstddef>
+#include <cstdio>
+
+class ListaDeCarga;
+class RotorDeMapeo;
+
+/// Versión del formato que escribe y entiende este código
+#define VERSION_BINARIO_PRT7 1
+
+/// Tamaño de la cabecera del formato binario
+#define TAM_CABECERA_BINARIO_PRT7 16
+
+/// Racha LOAD más larga que se codifica con la etiqueta corta
+#define MAX_RACHA_CORTA_PRT7 128
+
+/**
+ * @class EscritorBinarioPRT7
+ * @brief Escribe tramas en formato binario sobre un archivo
+ * @details Agrupa las tramas LOAD consecutivas en rachas. Al terminar
+ *          reescribe la cabecera con el número de tramas, por lo que el
+ *          archivo debe permitir fseek.
+ */
+class EscritorBinarioPRT7 {
+private:
+    FILE* salida;                ///< Archivo de destino
+    char* racha;                 ///< Caracteres LOAD pendientes
+    size_t pendientes;           ///< Caracteres en racha
+    size_t capacidadRacha;       ///< Capacidad de racha
+    unsigned long long tramas;   ///< Tramas escritas
+    bool error;                  ///< true si falló alguna escritura
+
+    /**
+     * @brief Escribe la racha LOAD pendiente
+     */
+    void vaciarRacha();
+
+    /**
+     * @brief Copia caracteres a la racha pendiente (crece si hace falta)
+     */
+    void copiarARacha(const char* datos, size_t n);
+
+    /**
+     * @brief Escribe un entero sin signo en varint
+     */
+    void escribirVarint(unsigned long long valor);
+
+public:
+    /**
+     * @brief Constructor
+     * @param archivo Archivo abierto en modo binario para escritura
+     * @details Escribe una cabecera provisional
+     */
+    explicit EscritorBinarioPRT7(FILE* archivo);
+
+    /**
+     * @brief Destructor (no cierra el archivo)
+     */
+    ~EscritorBinarioPRT7();
+
+    /**
+     * @brief Agrega una trama LOAD
+     * @param c Carácter de la trama
+     */
+    void agregarLoad(char c);
+
+    /**
+     * @brief Agrega varias tramas LOAD consecutivas
+     * @param datos Caracteres de las tramas
+     * @param n Número de tramas
+     */
+    void agregarLoads(const char* datos, size_t n);
+
+    /**
+     * @brief Agrega una trama MAP
+     * @param rotacion Rotación de la trama
+     */
+    void agregarMap(int rotacion);
+
+    /**
+     * @brief Escribe lo pendiente y actualiza la cabecera
+     * @return true si todas las escrituras tuvieron éxito
+     */
+    bool terminar();
+
+    /**
+     * @brief Obtiene el número de tramas escritas
+     * @return Tramas LOAD y MAP agregadas
+     */
+    unsigned long long getTramas() const { return tramas; }
+
+private:
+    EscritorBinarioPRT7(const EscritorBinarioPRT7&);
+    EscritorBinarioPRT7& operator=(const EscritorBinarioPRT7&);
+};
+
+/**
+ * @brief Indica si un bloque de datos es una captura binaria PRT-7
+ * @param datos Primer byte de la captura
+ * @param tamano Número de bytes
+ * @return true si empieza con la firma "PRT7"
+ */
+bool esCapturaBinaria(const char* datos, size_t tamano);
+
+/**
+ * @brief Decodifica una captura binaria completa
+ * @param datos Primer byte de la captura (incluida la cabecera)
+ * @param tamano Número de bytes
+ * @param carga Lista donde se insertan los caracteres decodificados
+ * @param rotor Rotor de mapeo; queda rotado según las tramas MAP
+ * @param tramas Salida: número de tramas procesadas
+ * @param numHilos Hilos a usar (0 = número de núcleos disponibles)
+ * @return true si la captura es válida; false si la versión no es
+ *         compatible o los datos están truncados o corruptos (en ese caso
+ *         se conserva lo decodificado hasta el error)
+ * @details No hay parseo por trama: las rachas LOAD se decodifican en
+ *          bloque y las rotaciones se acumulan en una variable local. Con
+ *          varios hilos la captura se procesa por ventanas: se recorren
+ *          las etiquetas para fijar el desplazamiento de cada racha y los
+ *          hilos decodifican partes disjuntas de la ventana.
+ */
+bool decodificarCapturaBinaria(const char* datos, size_t tamano,
+                               ListaDeCarga& carga, RotorDeMapeo& rotor,
+                               unsigned long long& tramas, int numHilos = 1);
+
+#endif // FORMATO_BINARIO_H
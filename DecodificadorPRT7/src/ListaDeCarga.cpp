@@ -5,8 +5,14 @@
 
 #include "ListaDeCarga.h"
 #include <cstdio>
+#include <cstring>
 
-ListaDeCarga::ListaDeCarga() : cabeza(nullptr), cola(nullptr), tamano(0) {
+/// Entradas iniciales del directorio de bloques
+static const size_t CAPACIDAD_DIRECTORIO_INICIAL = 16;
+
+ListaDeCarga::ListaDeCarga()
+    : cabeza(nullptr), cola(nullptr), tamano(0), directorio(nullptr),
+      numNodos(0), capacidadDirectorio(0) {
 }
 
 ListaDeCarga::~ListaDeCarga() {
@@ -17,10 +23,11 @@ ListaDeCarga::~ListaDeCarga() {
         delete actual;
         actual = siguiente;
     }
+    delete[] directorio;
 }
 
-void ListaDeCarga::insertarAlFinal(char dato) {
-    NodoCarga* nuevo = new NodoCarga(dato);
+void ListaDeCarga::agregarNodo() {
+    NodoCarga* nuevo = new NodoCarga();
 
     if (cabeza == nullptr) {
         // Lista vacía
@@ -33,26 +40,178 @@ void ListaDeCarga::insertarAlFinal(char dato) {
         cola = nuevo;
     }
 
-    tamano++;
+    // Registrar el nodo en el directorio (crece al doble cuando se llena)
+    if (numNodos == capacidadDirectorio) {
+        size_t capacidad = capacidadDirectorio > 0 ? capacidadDirectorio * 2 : CAPACIDAD_DIRECTORIO_INICIAL;
+        NodoCarga** nuevoDirectorio = new NodoCarga*[capacidad];
+        if (numNodos > 0) {
+            memcpy(nuevoDirectorio, directorio, numNodos * sizeof(NodoCarga*));
+        }
+        delete[] directorio;
+        directorio = nuevoDirectorio;
+        capacidadDirectorio = capacidad;
+    }
+    directorio[numNodos++] = nuevo;
 }
 
-void ListaDeCarga::imprimirMensaje() const {
-    NodoCarga* actual = cabeza;
-    while (actual != nullptr) {
-        printf("%c", actual->dato);
-        actual = actual->siguiente;
+void ListaDeCarga::insertarBloque(const char* datos, size_t cantidad) {
+    while (cantidad > 0) {
+        if (cola == nullptr || cola->cantidad == CAPACIDAD_NODO_CARGA) {
+            agregarNodo();
+        }
+
+        // Copiar tanto como quepa en el nodo cola
+        size_t libres = CAPACIDAD_NODO_CARGA - cola->cantidad;
+        size_t trozo = cantidad < libres ? cantidad : libres;
+        memcpy(cola->datos + cola->cantidad, datos, trozo);
+
+        cola->cantidad += (int)trozo;
+        tamano += trozo;
+        datos += trozo;
+        cantidad -= trozo;
     }
 }
 
-void ListaDeCarga::imprimirConFormato() const {
-    printf("Mensaje: [");
+/**
+ * @brief Acota un rango a los caracteres existentes
+ * @return Caracteres del rango que existen (0 si no hay ninguno)
+ */
+static size_t acotarRango(size_t desde, size_t cantidad, size_t tamano) {
+    if (desde >= tamano) return 0;
+    return cantidad < tamano - desde ? cantidad : tamano - desde;
+}
+
+size_t ListaDeCarga::extraerRango(size_t desde, size_t cantidad, char* destino) const {
+    size_t total = acotarRango(desde, cantidad, tamano);
+    size_t bloque = desde / CAPACIDAD_NODO_CARGA;
+    int indice = (int)(desde % CAPACIDAD_NODO_CARGA);
+
+    size_t copiados = 0;
+    while (copiados < total) {
+        const NodoCarga* nodo = directorio[bloque++];
+        size_t trozo = nodo->cantidad - indice;
+        if (trozo > total - copiados) trozo = total - copiados;
+
+        memcpy(destino + copiados, nodo->datos + indice, trozo);
+        copiados += trozo;
+        indice = 0;
+    }
+    return copiados;
+}
+
+size_t ListaDeCarga::escribirRango(size_t desde, size_t cantidad, EscritorSalida& salida) const {
+    size_t total = acotarRango(desde, cantidad, tamano);
+    size_t bloque = desde / CAPACIDAD_NODO_CARGA;
+    int indice = (int)(desde % CAPACIDAD_NODO_CARGA);
+
+    size_t escritos = 0;
+    while (escritos < total) {
+        const NodoCarga* nodo = directorio[bloque++];
+        size_t trozo = nodo->cantidad - indice;
+        if (trozo > total - escritos) trozo = total - escritos;
+
+        salida.escribir(nodo->datos + indice, trozo);
+        escritos += trozo;
+        indice = 0;
+    }
+    return escritos;
+}
+
+void ListaDeCarga::volcar(EscritorSalida& salida, FormatoSalida formato) const {
     NodoCarga* actual = cabeza;
-    while (actual != nullptr) {
-        printf("%c", actual->dato);
-        if (actual->siguiente != nullptr) {
-            printf("][");
+
+    switch (formato) {
+    case SALIDA_CRUDA:
+        while (actual != nullptr) {
+            salida.escribir(actual->datos, actual->cantidad);
+            actual = actual->siguiente;
+        }
+        break;
+
+    case SALIDA_CORCHETES:
+        salida.escribirCaracter('[');
+        while (actual != nullptr) {
+            for (int i = 0; i < actual->cantidad; i++) {
+                salida.escribirCaracter(actual->datos[i]);
+                if (i + 1 < actual->cantidad || actual->siguiente != nullptr) {
+                    salida.escribir("][", 2);
+                }
+            }
+            actual = actual->siguiente;
         }
-        actual = actual->siguiente;
+        salida.escribirCaracter(']');
+        break;
+
+    case SALIDA_NDJSON:
+        salida.escribirCadena("{\"mensaje\":\"");
+        while (actual != nullptr) {
+            salida.escribirJSON(actual->datos, actual->cantidad);
+            actual = actual->siguiente;
+        }
+        salida.escribirFormato("\",\"caracteres\":%zu}\n", tamano);
+        break;
+    }
+}
+
+void ListaDeCarga::imprimirMensaje() const {
+    EscritorSalida salida(stdout, TAM_BUFFER_CONSOLA);
+    volcar(salida, SALIDA_CRUDA);
+}
+
+/**
+ * @brief Tramo de recorrerNuevos que se copia a un EscritorSalida
+ */
+static void escribirTramo(const char* datos, int cantidad, void* contexto) {
+    static_cast<EscritorSalida*>(contexto)->escribir(datos, cantidad);
+}
+
+size_t ListaDeCarga::escribirNuevos(CursorCarga& cursor, EscritorSalida& salida) const {
+    return recorrerNuevos(cursor, escribirTramo, &salida);
+}
+
+size_t ListaDeCarga::recorrerNuevos(CursorCarga& cursor, void (*funcion)(const char*, int, void*),
+                                    void* contexto) const {
+    size_t pendientes = tamano - cursor.emitidos;
+    if (pendientes == 0) {
+        return 0;
     }
-    printf("]\n");
-}
\ No newline at end of file
+
+    // Cursor sin nodo: empezar desde la cabeza
+    if (cursor.nodo == nullptr) {
+        cursor.nodo = cabeza;
+        cursor.indice = 0;
+    }
+
+    for (;;) {
+        int trozo = cursor.nodo->cantidad - cursor.indice;
+        if (trozo > 0) {
+            funcion(cursor.nodo->datos + cursor.indice, trozo, contexto);
+            cursor.indice += trozo;
+        }
+
+        // El cursor se queda en el último nodo para retomar cuando crezca
+        if (cursor.nodo->siguiente == nullptr) {
+            break;
+        }
+        cursor.nodo = cursor.nodo->siguiente;
+        cursor.indice = 0;
+    }
+
+    cursor.emitidos = tamano;
+    return pendientes;
+}
+
+CursorCarga ListaDeCarga::cursorAlFinal() const {
+    CursorCarga cursor;
+    cursor.nodo = cola;
+    cursor.indice = cola != nullptr ? cola->cantidad : 0;
+    cursor.emitidos = tamano;
+    return cursor;
+}
+
+void ListaDeCarga::imprimirConFormato() const {
+    EscritorSalida salida(stdout, TAM_BUFFER_CONSOLA);
+    salida.escribirCadena("Mensaje: ");
+    volcar(salida, SALIDA_CORCHETES);
+    salida.escribirCaracter('\n');
+}
@@ -6,32 +6,128 @@
 #ifndef LISTA_DE_CARGA_H
 #define LISTA_DE_CARGA_H
 
+#include <cstddef>
+#include "EscritorSalida.h"
+
+/// Caracteres por nodo; el nodo completo ocupa 256 bytes en 64 bits
+static const int CAPACIDAD_NODO_CARGA = 256 - 2 * sizeof(void*) - sizeof(int);
+
 /**
  * @struct NodoCarga
- * @brief Nodo de la lista doblemente enlazada
+ * @brief Nodo de la lista doblemente enlazada desenrollada
+ * @details Cada nodo guarda un bloque de caracteres consecutivos en lugar de
+ *          uno solo, para no pagar dos punteros y una reserva por carácter
  */
 struct NodoCarga {
-    char dato;           ///< Carácter almacenado
-    NodoCarga* siguiente; ///< Puntero al siguiente nodo
-    NodoCarga* previo;    ///< Puntero al nodo previo
+    NodoCarga* siguiente;             ///< Puntero al siguiente nodo
+    NodoCarga* previo;                ///< Puntero al nodo previo
+    int cantidad;                     ///< Caracteres ocupados en datos
+    char datos[CAPACIDAD_NODO_CARGA]; ///< Caracteres almacenados
+
+    /**
+     * @brief Constructor del nodo vacío
+     */
+    NodoCarga() : siguiente(nullptr), previo(nullptr), cantidad(0) {}
+};
+
+/**
+ * @struct CursorCarga
+ * @brief Marca hasta dónde se emitió ya el contenido de una ListaDeCarga
+ * @details Como la lista sólo crece por el final, basta el nodo y la
+ *          posición del primer carácter pendiente para retomar sin recorrer
+ *          lo ya emitido. Cada consumidor (consola, punto de control...)
+ *          mantiene su propio cursor.
+ */
+struct CursorCarga {
+    NodoCarga* nodo; ///< Nodo del primer carácter pendiente (nullptr = desde la cabeza)
+    int indice;      ///< Posición de ese carácter dentro del nodo
+    size_t emitidos; ///< Caracteres anteriores al cursor
 
     /**
-     * @brief Constructor del nodo
-     * @param c Carácter a almacenar
+     * @brief Constructor de un cursor al inicio de la lista
      */
-    NodoCarga(char c) : dato(c), siguiente(nullptr), previo(nullptr) {}
+    CursorCarga() : nodo(nullptr), indice(0), emitidos(0) {}
+};
+
+/**
+ * @class IteradorCarga
+ * @brief Recorre los caracteres de una ListaDeCarga en ambos sentidos
+ */
+class IteradorCarga {
+private:
+    NodoCarga* nodo; ///< Nodo actual (nullptr si se salió de la lista)
+    int indice;      ///< Posición dentro del nodo actual
+
+public:
+    /**
+     * @brief Constructor
+     * @param n Nodo inicial
+     * @param i Posición dentro del nodo
+     */
+    IteradorCarga(NodoCarga* n, int i) : nodo(n), indice(i) {}
+
+    /**
+     * @brief Indica si el iterador apunta a un carácter válido
+     * @return true si se puede leer con valor()
+     */
+    bool valido() const { return nodo != nullptr; }
+
+    /**
+     * @brief Obtiene el carácter actual
+     * @return Carácter apuntado (el iterador debe ser válido)
+     */
+    char valor() const { return nodo->datos[indice]; }
+
+    /**
+     * @brief Avanza al siguiente carácter
+     */
+    void avanzar() {
+        if (++indice >= nodo->cantidad) {
+            nodo = nodo->siguiente;
+            indice = 0;
+        }
+    }
+
+    /**
+     * @brief Retrocede al carácter anterior
+     */
+    void retroceder() {
+        if (--indice < 0) {
+            nodo = nodo->previo;
+            indice = nodo ? nodo->cantidad - 1 : 0;
+        }
+    }
 };
 
 /**
  * @class ListaDeCarga
  * @brief Lista doblemente enlazada que almacena el mensaje decodificado
- * @details Mantiene el orden de los fragmentos de datos según son procesados
+ * @details Mantiene el orden de los fragmentos de datos según son procesados.
+ *          Es una lista desenrollada: los caracteres se agrupan en bloques
+ *          de CAPACIDAD_NODO_CARGA y sólo el último nodo puede estar
+ *          parcialmente lleno.
+ *
+ *          Como todos los nodos salvo el último están llenos, el carácter k
+ *          vive en el nodo k / CAPACIDAD_NODO_CARGA. Un directorio de
+ *          bloques (arreglo de punteros a nodo, uno por nodo) permite llegar
+ *          a él en O(1) sin alterar los enlaces previo/siguiente.
  */
 class ListaDeCarga {
 private:
     NodoCarga* cabeza; ///< Puntero al primer nodo
     NodoCarga* cola;   ///< Puntero al último nodo
-    int tamano;        ///< Número de elementos
+    size_t tamano;     ///< Número de caracteres
+
+    NodoCarga** directorio;     ///< Directorio de bloques: nodo i de la lista
+    size_t numNodos;            ///< Entradas usadas del directorio
+    size_t capacidadDirectorio; ///< Entradas reservadas del directorio
+
+    CursorCarga cursorSalida; ///< Caracteres ya emitidos por imprimirNuevos
+
+    /**
+     * @brief Agrega un nodo vacío al final de la lista
+     */
+    void agregarNodo();
 
 public:
     /**
@@ -49,7 +145,63 @@ public:
      * @param dato Carácter a insertar
      * @details Mantiene el orden de llegada de los datos decodificados
      */
-    void insertarAlFinal(char dato);
+    void insertarAlFinal(char dato) {
+        if (cola == nullptr || cola->cantidad == CAPACIDAD_NODO_CARGA) {
+            agregarNodo();
+        }
+        cola->datos[cola->cantidad++] = dato;
+        tamano++;
+    }
+
+    /**
+     * @brief Inserta varios caracteres al final de la lista
+     * @param datos Caracteres a insertar, en orden
+     * @param cantidad Número de caracteres
+     */
+    void insertarBloque(const char* datos, size_t cantidad);
+
+    /**
+     * @brief Obtiene el carácter en una posición
+     * @param posicion Índice del carácter, desde 0
+     * @return Carácter almacenado, o '\0' si la posición está fuera de rango
+     * @details O(1): consulta el directorio de bloques
+     */
+    char obtenerEn(size_t posicion) const {
+        if (posicion >= tamano) return '\0';
+        return directorio[posicion / CAPACIDAD_NODO_CARGA]->datos[posicion % CAPACIDAD_NODO_CARGA];
+    }
+
+    /**
+     * @brief Iterador situado en una posición
+     * @param posicion Índice del carácter, desde 0
+     * @return Iterador (no válido si la posición está fuera de rango)
+     * @details Permite recorrer una ventana con avanzar()/retroceder()
+     *          a partir de cualquier punto sin caminar desde la cabeza
+     */
+    IteradorCarga iteradorEn(size_t posicion) const {
+        if (posicion >= tamano) return IteradorCarga(nullptr, 0);
+        return IteradorCarga(directorio[posicion / CAPACIDAD_NODO_CARGA],
+                             (int)(posicion % CAPACIDAD_NODO_CARGA));
+    }
+
+    /**
+     * @brief Copia un rango de caracteres
+     * @param desde Posición del primer carácter
+     * @param cantidad Caracteres a copiar
+     * @param destino Búfer de al menos cantidad bytes (no se agrega '\0')
+     * @return Caracteres copiados (menos que cantidad si el rango excede la lista)
+     * @details Un memcpy por bloque tocado: O(cantidad / CAPACIDAD_NODO_CARGA + 1)
+     */
+    size_t extraerRango(size_t desde, size_t cantidad, char* destino) const;
+
+    /**
+     * @brief Escribe un rango de caracteres
+     * @param desde Posición del primer carácter
+     * @param cantidad Caracteres a escribir
+     * @param salida Escritor de destino (no se vacía)
+     * @return Caracteres escritos
+     */
+    size_t escribirRango(size_t desde, size_t cantidad, EscritorSalida& salida) const;
 
     /**
      * @brief Imprime el mensaje completo ensamblado
@@ -57,11 +209,58 @@ public:
      */
     void imprimirMensaje() const;
 
+    /**
+     * @brief Vuelca el mensaje completo en el formato indicado
+     * @param salida Escritor de destino (no se vacía)
+     * @param formato Cruda, entre corchetes o una línea NDJSON
+     */
+    void volcar(EscritorSalida& salida, FormatoSalida formato) const;
+
+    /**
+     * @brief Escribe sólo los caracteres agregados desde la llamada anterior
+     * @param salida Escritor de destino (no se vacía)
+     * @return Número de caracteres emitidos
+     * @details Avanza el cursor de "último volcado": cada carácter se emite
+     *          una sola vez, copiando tramos de nodo completos, así que
+     *          mostrar el mensaje a medida que llega cuesta O(n) en total
+     */
+    size_t imprimirNuevos(EscritorSalida& salida) { return escribirNuevos(cursorSalida, salida); }
+
+    /**
+     * @brief Escribe los caracteres posteriores a un cursor y lo avanza
+     * @param cursor Cursor del consumidor (queda al final de la lista)
+     * @param salida Escritor de destino (no se vacía)
+     * @return Número de caracteres emitidos
+     */
+    size_t escribirNuevos(CursorCarga& cursor, EscritorSalida& salida) const;
+
+    /**
+     * @brief Recorre por tramos los caracteres posteriores a un cursor y lo avanza
+     * @param cursor Cursor del consumidor (queda al final de la lista)
+     * @param funcion Se llama una vez por tramo contiguo (datos, cantidad, contexto)
+     * @param contexto Puntero que se pasa sin cambios a funcion
+     * @return Número de caracteres recorridos
+     */
+    size_t recorrerNuevos(CursorCarga& cursor, void (*funcion)(const char*, int, void*),
+                          void* contexto) const;
+
+    /**
+     * @brief Obtiene un cursor situado después del último carácter
+     * @return Cursor para el que no hay caracteres pendientes
+     */
+    CursorCarga cursorAlFinal() const;
+
+    /**
+     * @brief Obtiene los caracteres pendientes de volcar
+     * @return Caracteres agregados después del último imprimirNuevos
+     */
+    size_t getPendientes() const { return tamano - cursorSalida.emitidos; }
+
     /**
      * @brief Obtiene el tamaño de la lista
      * @return Número de caracteres almacenados
      */
-    int getTamano() const { return tamano; }
+    size_t getTamano() const { return tamano; }
 
     /**
      * @brief Verifica si la lista está vacía
@@ -73,6 +272,18 @@ public:
      * @brief Imprime el mensaje con formato detallado (para debug)
      */
     void imprimirConFormato() const;
+
+    /**
+     * @brief Iterador al primer carácter
+     * @return Iterador (no válido si la lista está vacía)
+     */
+    IteradorCarga inicio() const { return IteradorCarga(cabeza, 0); }
+
+    /**
+     * @brief Iterador al último carácter
+     * @return Iterador (no válido si la lista está vacía)
+     */
+    IteradorCarga fin() const { return IteradorCarga(cola, cola ? cola->cantidad - 1 : 0); }
 };
 
-#endif // LISTA_DE_CARGA_H
\ No newline at end of file
+#endif // LISTA_DE_CARGA_H
@@ -0,0 +1,229 @@
+/**
+ * @file MetricasPRT7.cpp
+ * @brief Implementación de las métricas del decodificador
+ */
+
+#include "MetricasPRT7.h"
+#include <chrono>
+#include <cstring>
+#include <csignal>
+
+unsigned long long relojNs() {
+    return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Calcula la cubeta de un valor (su número de bits significativos)
+ */
+static inline int indiceCubeta(unsigned long long ns) {
+    if (ns == 0) return 0;
+#if defined(__GNUC__) || defined(__clang__)
+    int k = 64 - __builtin_clzll(ns);
+#else
+    int k = 0;
+    while (ns != 0) {
+        ns >>= 1;
+        k++;
+    }
+#endif
+    return k < CUBETAS_HISTOGRAMA ? k : CUBETAS_HISTOGRAMA - 1;
+}
+
+HistogramaLatencia::HistogramaLatencia() : cuenta(0), suma(0), maximo(0) {
+    for (int k = 0; k < CUBETAS_HISTOGRAMA; k++) {
+        cubetas[k].store(0, std::memory_order_relaxed);
+    }
+}
+
+void HistogramaLatencia::registrar(unsigned long long ns, unsigned long long veces) {
+    sumarContador(cubetas[indiceCubeta(ns)], veces);
+    sumarContador(cuenta, veces);
+    sumarContador(suma, ns * veces);
+    if (ns > maximo.load(std::memory_order_relaxed)) {
+        maximo.store(ns, std::memory_order_relaxed);
+    }
+}
+
+unsigned long long HistogramaLatencia::percentil(double p) const {
+    unsigned long long total = getCuenta();
+    if (total == 0) return 0;
+
+    unsigned long long objetivo = (unsigned long long)(p * total);
+    if (objetivo >= total) objetivo = total - 1;
+
+    // La última cubeta no tiene límite superior: usar el máximo observado
+    unsigned long long acumulado = 0;
+    for (int k = 0; k < CUBETAS_HISTOGRAMA - 1; k++) {
+        acumulado += getCubeta(k);
+        if (acumulado > objetivo) {
+            return limiteCubeta(k);
+        }
+    }
+    return getMaximo();
+}
+
+MetricasPRT7::MetricasPRT7()
+    : tramasLoad(0), tramasMap(0), tramasInvalidas(0), bytesLeidos(0),
+      lecturas(0), esperaSerialNs(0), inicioNs(relojNs()) {
+}
+
+/**
+ * @brief Escribe un histograma en formato Prometheus
+ */
+static void escribirHistogramaPrometheus(EscritorSalida& salida, const char* nombre,
+                                         const char* ayuda, const HistogramaLatencia& h) {
+    salida.escribirFormato("# HELP %s %s\n# TYPE %s histogram\n", nombre, ayuda, nombre);
+
+    // le es inclusivo; la última cubeta acota lo mayor y sólo entra en +Inf
+    unsigned long long acumulado = 0;
+    for (int k = 0; k < CUBETAS_HISTOGRAMA - 1; k++) {
+        acumulado += h.getCubeta(k);
+        salida.escribirFormato("%s_bucket{le=\"%llu\"} %llu\n", nombre,
+                               HistogramaLatencia::limiteCubeta(k), acumulado);
+    }
+    salida.escribirFormato("%s_bucket{le=\"+Inf\"} %llu\n", nombre, h.getCuenta());
+    salida.escribirFormato("%s_sum %llu\n%s_count %llu\n", nombre, h.getSuma(), nombre, h.getCuenta());
+}
+
+void escribirMetricasPrometheus(const MetricasPRT7& m, EscritorSalida& salida) {
+    salida.escribirCadena("# HELP prt7_tramas_total Tramas válidas decodificadas\n"
+                          "# TYPE prt7_tramas_total counter\n");
+    salida.escribirFormato("prt7_tramas_total{tipo=\"load\"} %llu\n", m.tramasLoad.load());
+    salida.escribirFormato("prt7_tramas_total{tipo=\"map\"} %llu\n", m.tramasMap.load());
+
+    salida.escribirCadena("# HELP prt7_tramas_invalidas_total Líneas rechazadas por el parser\n"
+                          "# TYPE prt7_tramas_invalidas_total counter\n");
+    salida.escribirFormato("prt7_tramas_invalidas_total %llu\n", m.tramasInvalidas.load());
+
+    salida.escribirCadena("# HELP prt7_bytes_leidos_total Bytes recibidos\n"
+                          "# TYPE prt7_bytes_leidos_total counter\n");
+    salida.escribirFormato("prt7_bytes_leidos_total %llu\n", m.bytesLeidos.load());
+
+    salida.escribirCadena("# HELP prt7_lecturas_total Lecturas del puerto con datos\n"
+                          "# TYPE prt7_lecturas_total counter\n");
+    salida.escribirFormato("prt7_lecturas_total %llu\n", m.lecturas.load());
+
+    salida.escribirCadena("# HELP prt7_espera_serial_ns_total Tiempo bloqueado esperando datos\n"
+                          "# TYPE prt7_espera_serial_ns_total counter\n");
+    salida.escribirFormato("prt7_espera_serial_ns_total %llu\n", m.esperaSerialNs.load());
+
+    salida.escribirCadena("# HELP prt7_tiempo_ejecucion_ns Tiempo desde el arranque\n"
+                          "# TYPE prt7_tiempo_ejecucion_ns gauge\n");
+    salida.escribirFormato("prt7_tiempo_ejecucion_ns %llu\n", relojNs() - m.inicioNs);
+
+    escribirHistogramaPrometheus(salida, "prt7_latencia_parseo_ns",
+                                 "Latencia de análisis por trama", m.latenciaParseo);
+    escribirHistogramaPrometheus(salida, "prt7_latencia_decodificacion_ns",
+                                 "Latencia de decodificación por trama", m.latenciaDecodificacion);
+    escribirHistogramaPrometheus(salida, "prt7_espera_serial_ns",
+                                 "Duración de cada espera de datos", m.esperaSerial);
+}
+
+/**
+ * @brief Escribe un histograma como objeto JSON
+ */
+static void escribirHistogramaJSON(EscritorSalida& salida, const char* nombre,
+                                   const HistogramaLatencia& h) {
+    salida.escribirFormato("\"%s\":{\"cuenta\":%llu,\"suma\":%llu,\"maximo\":%llu,"
+                           "\"p50\":%llu,\"p90\":%llu,\"p99\":%llu,\"cubetas\":[",
+                           nombre, h.getCuenta(), h.getSuma(), h.getMaximo(),
+                           h.percentil(0.50), h.percentil(0.90), h.percentil(0.99));
+    for (int k = 0; k < CUBETAS_HISTOGRAMA; k++) {
+        salida.escribirFormato(k == 0 ? "%llu" : ",%llu", h.getCubeta(k));
+    }
+    salida.escribirCadena("]}");
+}
+
+void escribirMetricasJSON(const MetricasPRT7& m, EscritorSalida& salida) {
+    salida.escribirFormato("{\"tiempo_ejecucion_ns\":%llu,\"tramas\":{\"load\":%llu,\"map\":%llu,"
+                           "\"invalidas\":%llu},\"bytes_leidos\":%llu,\"lecturas\":%llu,"
+                           "\"espera_serial_ns\":%llu,",
+                           relojNs() - m.inicioNs, m.tramasLoad.load(), m.tramasMap.load(),
+                           m.tramasInvalidas.load(), m.bytesLeidos.load(), m.lecturas.load(),
+                           m.esperaSerialNs.load());
+    escribirHistogramaJSON(salida, "latencia_parseo_ns", m.latenciaParseo);
+    salida.escribirCaracter(',');
+    escribirHistogramaJSON(salida, "latencia_decodificacion_ns", m.latenciaDecodificacion);
+    salida.escribirCaracter(',');
+    escribirHistogramaJSON(salida, "espera_serial_ns", m.esperaSerial);
+    salida.escribirCadena("}\n");
+}
+
+bool guardarMetricas(const MetricasPRT7& metricas, const char* ruta) {
+    char temporal[1024];
+    int n = snprintf(temporal, sizeof(temporal), "%s.tmp", ruta);
+    if (n < 0 || (size_t)n >= sizeof(temporal)) {
+        return false;
+    }
+
+    FILE* archivo = fopen(temporal, "wb");
+    if (archivo == nullptr) {
+        return false;
+    }
+
+    size_t largo = strlen(ruta);
+    bool json = largo >= 5 && strcmp(ruta + largo - 5, ".json") == 0;
+
+    bool correcto;
+    {
+        EscritorSalida salida(archivo, 64 * 1024);
+        if (json) {
+            escribirMetricasJSON(metricas, salida);
+        } else {
+            escribirMetricasPrometheus(metricas, salida);
+        }
+        correcto = salida.vaciar();
+    }
+    correcto = fclose(archivo) == 0 && correcto;
+
+#ifdef _WIN32
+    // rename() no reemplaza un archivo existente en Windows
+    remove(ruta);
+#endif
+    return correcto && rename(temporal, ruta) == 0;
+}
+
+void imprimirLineaEstadisticas(const MetricasPRT7& m, FILE* salida) {
+    unsigned long long transcurrido = relojNs() - m.inicioNs;
+    double espera = transcurrido > 0 ? 100.0 * m.esperaSerialNs.load() / transcurrido : 0.0;
+
+    fprintf(salida,
+            "[estadisticas] t=%.1fs load=%llu map=%llu invalidas=%llu bytes=%llu "
+            "parseo p50/p99=%llu/%lluns decodificacion p50/p99=%llu/%lluns espera=%.1f%%\n",
+            transcurrido / 1e9, m.tramasLoad.load(), m.tramasMap.load(),
+            m.tramasInvalidas.load(), m.bytesLeidos.load(),
+            m.latenciaParseo.percentil(0.50), m.latenciaParseo.percentil(0.99),
+            m.latenciaDecodificacion.percentil(0.50), m.latenciaDecodificacion.percentil(0.99),
+            espera);
+    fflush(salida);
+}
+
+#ifdef SIGUSR1
+/// Se pone en 1 desde el manejador de SIGUSR1
+static volatile sig_atomic_t senalMetricasPendiente = 0;
+
+/**
+ * @brief Manejador de SIGUSR1: sólo marca la solicitud
+ */
+static void manejarSenalMetricas(int) {
+    senalMetricasPendiente = 1;
+}
+
+void instalarSenalMetricas() {
+    signal(SIGUSR1, manejarSenalMetricas);
+}
+
+bool consumirSenalMetricas() {
+    if (senalMetricasPendiente == 0) return false;
+    senalMetricasPendiente = 0;
+    return true;
+}
+#else
+void instalarSenalMetricas() {
+}
+
+bool consumirSenalMetricas() {
+    return false;
+}
+#endif
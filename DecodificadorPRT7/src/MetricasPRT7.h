@@ -0,0 +1,175 @@
+/**
+ * @file MetricasPRT7.h
+ * @brief Contadores e histogramas del bucle de decodificación
+ * @details Permiten saber si el decodificador está limitado por la E/S
+ *          serial o por la CPU. Cada contador tiene un único hilo escritor
+ *          (el lector o el decodificador), así que se actualiza con una
+ *          carga y un almacenamiento relajados, sin instrucciones atómicas
+ *          de lectura-modificación-escritura; cualquier hilo puede leerlos.
+ */
+
+#ifndef METRICAS_PRT7_H
+#define METRICAS_PRT7_H
+
+#include <atomic>
+#include <cstdio>
+#include "EscritorSalida.h"
+
+/// Cubetas del histograma: la cubeta k cuenta valores en [2^(k-1), 2^k - 1]
+/// (la 0 sólo el 0); la última cuenta además todos los valores mayores
+#define CUBETAS_HISTOGRAMA 40
+
+/**
+ * @brief Suma a un contador con un solo hilo escritor
+ * @param contador Contador a incrementar
+ * @param n Cantidad a sumar
+ */
+inline void sumarContador(std::atomic<unsigned long long>& contador, unsigned long long n) {
+    contador.store(contador.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Lee el reloj monótono
+ * @return Nanosegundos desde un origen arbitrario
+ */
+unsigned long long relojNs();
+
+/**
+ * @class HistogramaLatencia
+ * @brief Histograma logarítmico (base 2) de latencias en nanosegundos
+ * @details Un único hilo escritor. Los percentiles se aproximan por el
+ *          límite superior de la cubeta, con error menor a 2x.
+ */
+class HistogramaLatencia {
+private:
+    std::atomic<unsigned long long> cubetas[CUBETAS_HISTOGRAMA]; ///< Cuentas por cubeta
+    std::atomic<unsigned long long> cuenta;  ///< Muestras registradas
+    std::atomic<unsigned long long> suma;    ///< Suma de las muestras
+    std::atomic<unsigned long long> maximo;  ///< Mayor muestra
+
+public:
+    /**
+     * @brief Constructor del histograma vacío
+     */
+    HistogramaLatencia();
+
+    /**
+     * @brief Registra una o varias muestras con el mismo valor
+     * @param ns Latencia en nanosegundos
+     * @param veces Número de muestras (por ejemplo, tramas de un lote
+     *              cronometrado en conjunto)
+     */
+    void registrar(unsigned long long ns, unsigned long long veces = 1);
+
+    /**
+     * @brief Obtiene el número de muestras
+     * @return Muestras registradas
+     */
+    unsigned long long getCuenta() const { return cuenta.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Obtiene la suma de las muestras
+     * @return Suma en nanosegundos
+     */
+    unsigned long long getSuma() const { return suma.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Obtiene la mayor muestra
+     * @return Máximo en nanosegundos
+     */
+    unsigned long long getMaximo() const { return maximo.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Obtiene la cuenta de una cubeta
+     * @param k Índice de la cubeta (0..CUBETAS_HISTOGRAMA-1)
+     * @return Muestras en la cubeta
+     */
+    unsigned long long getCubeta(int k) const { return cubetas[k].load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Límite superior (inclusivo) de una cubeta
+     * @param k Índice de la cubeta (sin acotar sólo hasta CUBETAS_HISTOGRAMA-2)
+     * @return 2^k - 1 nanosegundos
+     */
+    static unsigned long long limiteCubeta(int k) { return (1ULL << k) - 1; }
+
+    /**
+     * @brief Aproxima un percentil
+     * @param p Percentil entre 0 y 1
+     * @return Límite superior de la cubeta que contiene el percentil, el
+     *         máximo si cae en la última cubeta (0 si vacío)
+     */
+    unsigned long long percentil(double p) const;
+};
+
+/**
+ * @struct MetricasPRT7
+ * @brief Métricas de una ejecución del decodificador
+ */
+struct MetricasPRT7 {
+    std::atomic<unsigned long long> tramasLoad;      ///< Tramas LOAD decodificadas
+    std::atomic<unsigned long long> tramasMap;       ///< Tramas MAP decodificadas
+    std::atomic<unsigned long long> tramasInvalidas; ///< Líneas rechazadas por el parser
+    std::atomic<unsigned long long> bytesLeidos;     ///< Bytes recibidos del puerto o la captura
+    std::atomic<unsigned long long> lecturas;        ///< Lecturas del puerto con datos
+    std::atomic<unsigned long long> esperaSerialNs;  ///< Tiempo bloqueado esperando datos
+    HistogramaLatencia latenciaParseo;        ///< Análisis de una línea, por trama
+    HistogramaLatencia latenciaDecodificacion; ///< Decodificación y eco, por trama
+    HistogramaLatencia esperaSerial;          ///< Duración de cada espera en poll()
+    unsigned long long inicioNs;              ///< Reloj al crear las métricas
+
+    /**
+     * @brief Constructor con todos los contadores en cero
+     */
+    MetricasPRT7();
+
+private:
+    MetricasPRT7(const MetricasPRT7&);
+    MetricasPRT7& operator=(const MetricasPRT7&);
+};
+
+/**
+ * @brief Escribe las métricas en el formato de texto de Prometheus
+ * @param metricas Métricas a exportar
+ * @param salida Escritor de destino
+ */
+void escribirMetricasPrometheus(const MetricasPRT7& metricas, EscritorSalida& salida);
+
+/**
+ * @brief Escribe las métricas como un objeto JSON en una línea
+ * @param metricas Métricas a exportar
+ * @param salida Escritor de destino
+ */
+void escribirMetricasJSON(const MetricasPRT7& metricas, EscritorSalida& salida);
+
+/**
+ * @brief Guarda las métricas en un archivo
+ * @param metricas Métricas a exportar
+ * @param ruta Archivo destino; si termina en ".json" se usa JSON y si no,
+ *             el formato de texto de Prometheus
+ * @return true si se escribió correctamente
+ * @details Escribe en "ruta.tmp" y lo renombra, de modo que un recolector
+ *          nunca lea un archivo a medio escribir
+ */
+bool guardarMetricas(const MetricasPRT7& metricas, const char* ruta);
+
+/**
+ * @brief Imprime una línea de estadísticas resumida
+ * @param metricas Métricas a mostrar
+ * @param salida Flujo de destino (normalmente stderr)
+ */
+void imprimirLineaEstadisticas(const MetricasPRT7& metricas, FILE* salida);
+
+/**
+ * @brief Instala el manejador de SIGUSR1 que solicita un volcado de métricas
+ * @details Sin efecto en plataformas sin SIGUSR1
+ */
+void instalarSenalMetricas();
+
+/**
+ * @brief Indica si llegó SIGUSR1 desde la última consulta
+ * @return true una vez por cada señal recibida
+ */
+bool consumirSenalMetricas();
+
+#endif // METRICAS_PRT7_H
@@ -0,0 +1,209 @@
+/**
+ * @file ParserTramas.cpp
+ * @brief Implementación del parser de tramas PRT-7
+ */
+
+#include "ParserTramas.h"
+#include "ArenaTramas.h"
+#include "TramaLoad.h"
+#include "TramaMap.h"
+#include <cstring>
+#include <climits>
+
+/**
+ * @brief Indica si un carácter es espacio en blanco para el protocolo
+ */
+static inline bool esEspacio(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/**
+ * @brief Verifica que el resto de la línea sólo tenga espacios
+ */
+static inline bool soloEspacios(const char* p, const char* fin) {
+    while (p < fin) {
+        if (!esEspacio(*p)) return false;
+        p++;
+    }
+    return true;
+}
+
+ResultadoTrama analizarTrama(const char* datos, size_t longitud) {
+    ResultadoTrama r;
+    r.trama.valor = 0;
+    r.trama.tipo = 0;
+    r.error = TRAMA_OK;
+
+    if (datos == nullptr) {
+        r.error = TRAMA_ERROR_VACIA;
+        return r;
+    }
+
+    const char* p = datos;
+    const char* fin = datos + longitud;
+
+    // Saltar espacios iniciales
+    while (p < fin && esEspacio(*p)) {
+        p++;
+    }
+    if (p == fin) {
+        r.error = TRAMA_ERROR_VACIA;
+        return r;
+    }
+
+    char tipo = *p++;
+    if (tipo >= 'a' && tipo <= 'z') {
+        tipo = tipo - 'a' + 'A';
+    }
+    if (tipo != TRAMA_LOAD && tipo != TRAMA_MAP) {
+        r.error = TRAMA_ERROR_TIPO;
+        return r;
+    }
+
+    if (p == fin || *p != ',') {
+        r.error = TRAMA_ERROR_FORMATO;
+        return r;
+    }
+    p++;
+
+    if (tipo == TRAMA_LOAD) {
+        // Trama LOAD: exactamente un carácter (puede ser un espacio)
+        if (p == fin || *p == '\r' || *p == '\n') {
+            r.error = TRAMA_ERROR_FORMATO;
+            return r;
+        }
+        char caracter = *p++;
+        if (!soloEspacios(p, fin)) {
+            r.error = TRAMA_ERROR_BASURA;
+            return r;
+        }
+        r.trama = crearTramaLoad(caracter);
+        return r;
+    }
+
+    // Trama MAP: entero con signo opcional
+    bool negativo = false;
+    if (p < fin && (*p == '-' || *p == '+')) {
+        negativo = (*p == '-');
+        p++;
+    }
+    if (p == fin || esEspacio(*p)) {
+        r.error = TRAMA_ERROR_FORMATO;
+        return r;
+    }
+    if (*p < '0' || *p > '9') {
+        r.error = TRAMA_ERROR_NUMERO;
+        return r;
+    }
+
+    // Acotar a INT_MAX + 1 para aceptar INT_MIN y detectar desbordes
+    long long valor = 0;
+    while (p < fin && *p >= '0' && *p <= '9') {
+        valor = valor * 10 + (*p - '0');
+        if (valor > (long long)INT_MAX + 1) {
+            r.error = TRAMA_ERROR_RANGO;
+            return r;
+        }
+        p++;
+    }
+    if (negativo) valor = -valor;
+    if (valor > INT_MAX || valor < INT_MIN) {
+        r.error = TRAMA_ERROR_RANGO;
+        return r;
+    }
+
+    if (!soloEspacios(p, fin)) {
+        r.error = TRAMA_ERROR_BASURA;
+        return r;
+    }
+
+    r.trama = crearTramaMap((int)valor);
+    return r;
+}
+
+bool contieneMarca(const char* linea, int longitud, const char* marca) {
+    int largoMarca = strlen(marca);
+    for (int i = 0; i + largoMarca <= longitud; i++) {
+        if (linea[i] == marca[0] && memcmp(linea + i, marca, largoMarca) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool clasificarLinea(const char* datos, int longitud, TramaCompacta& trama) {
+    // Camino rápido: misma respuesta que analizarTrama para "L,X"
+    if (longitud == 3 && (datos[0] == 'L' || datos[0] == 'l') && datos[1] == ',' &&
+        datos[2] != '\r' && datos[2] != '\n') {
+        trama = crearTramaLoad(datos[2]);
+        return true;
+    }
+
+    // Una línea más corta que las marcas no puede contenerlas
+    if (longitud >= (int)sizeof(MARCA_FIN_PRT7) - 1) {
+        if (contieneMarca(datos, longitud, MARCA_INICIO_PRT7)) {
+            trama = crearTramaControl(TRAMA_INICIO);
+            return true;
+        }
+        if (contieneMarca(datos, longitud, MARCA_FIN_PRT7)) {
+            trama = crearTramaControl(TRAMA_FIN);
+            return true;
+        }
+    }
+
+    ResultadoTrama r = analizarTrama(datos, (size_t)longitud);
+    if (r.error == TRAMA_ERROR_VACIA) {
+        return false;
+    }
+
+    trama = r.error == TRAMA_OK ? r.trama : crearTramaControl(TRAMA_INVALIDA, r.error);
+    return true;
+}
+
+const char* descripcionErrorTrama(ErrorTrama error) {
+    switch (error) {
+        case TRAMA_OK:            return "sin error";
+        case TRAMA_ERROR_VACIA:   return "línea vacía";
+        case TRAMA_ERROR_FORMATO: return "formato incompleto";
+        case TRAMA_ERROR_TIPO:    return "tipo de trama desconocido";
+        case TRAMA_ERROR_NUMERO:  return "rotación no numérica";
+        case TRAMA_ERROR_RANGO:   return "rotación fuera de rango";
+        case TRAMA_ERROR_BASURA:  return "caracteres sobrantes";
+    }
+    return "error desconocido";
+}
+
+TramaBase* parsearTrama(const char* linea) {
+    if (linea == nullptr) return nullptr;
+
+    ResultadoTrama r = analizarTrama(linea, strlen(linea));
+    if (r.error != TRAMA_OK) {
+        return nullptr;
+    }
+
+    if (r.trama.tipo == TRAMA_LOAD) {
+        return new TramaLoad((char)r.trama.valor);
+    }
+    return new TramaMap(r.trama.valor);
+}
+
+TramaBase* parsearTrama(const char* linea, ArenaTramas& arena) {
+    if (linea == nullptr) return nullptr;
+    return parsearTrama(linea, strlen(linea), arena);
+}
+
+TramaBase* parsearTrama(const char* datos, size_t longitud, ArenaTramas& arena,
+                        ErrorTrama* error) {
+    ResultadoTrama r = analizarTrama(datos, longitud);
+    if (error != nullptr) {
+        *error = r.error;
+    }
+    if (r.error != TRAMA_OK) {
+        return nullptr;
+    }
+
+    if (r.trama.tipo == TRAMA_LOAD) {
+        return arena.crear<TramaLoad>((char)r.trama.valor);
+    }
+    return arena.crear<TramaMap>(r.trama.valor);
+}
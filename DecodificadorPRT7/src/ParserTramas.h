@@ -0,0 +1,114 @@
+/**
+ * @file ParserTramas.h
+ * @brief Interpretación de las líneas del protocolo PRT-7
+ */
+
+#ifndef PARSER_TRAMAS_H
+#define PARSER_TRAMAS_H
+
+#include <cstddef>
+#include "TramaCompacta.h"
+
+class TramaBase;
+class ArenaTramas;
+
+/**
+ * @enum ErrorTrama
+ * @brief Motivo por el que una línea no es una trama válida
+ */
+enum ErrorTrama {
+    TRAMA_OK = 0,          ///< Trama válida
+    TRAMA_ERROR_VACIA,     ///< Línea vacía o sólo espacios
+    TRAMA_ERROR_FORMATO,   ///< Falta la coma o el valor
+    TRAMA_ERROR_TIPO,      ///< Tipo distinto de 'L' o 'M'
+    TRAMA_ERROR_NUMERO,    ///< La rotación de una trama MAP no es un entero
+    TRAMA_ERROR_RANGO,     ///< La rotación no cabe en un int
+    TRAMA_ERROR_BASURA     ///< Caracteres sobrantes después del valor
+};
+
+/**
+ * @struct ResultadoTrama
+ * @brief Resultado del análisis de una línea: trama y código de error
+ * @details trama sólo es significativa si error == TRAMA_OK
+ */
+struct ResultadoTrama {
+    TramaCompacta trama; ///< Tipo y valor de la trama
+    ErrorTrama error;    ///< TRAMA_OK o el motivo del rechazo
+};
+
+/**
+ * @brief Analiza una línea PRT-7 directamente sobre sus bytes
+ * @param datos Primer carácter de la línea (no necesita terminar en '\0')
+ * @param longitud Número de caracteres de la línea
+ * @return Trama compacta y código de error
+ * @details No copia ni reserva memoria. Admite espacios al inicio y al
+ *          final, tipo en mayúscula o minúscula y signo opcional en MAP.
+ *          Rechaza valores ausentes, rotaciones fuera de rango y cualquier
+ *          carácter sobrante (por ejemplo "M,abc" o "L,AB").
+ */
+ResultadoTrama analizarTrama(const char* datos, size_t longitud);
+
+/// Marca de control que abre una transmisión
+#define MARCA_INICIO_PRT7 "INICIO_TRANSMISION_PRT7"
+
+/// Marca de control que cierra una transmisión
+#define MARCA_FIN_PRT7 "FIN_TRANSMISION_PRT7"
+
+/**
+ * @brief Indica si una línea contiene una marca de control
+ * @param linea Línea (no necesita terminar en '\0')
+ * @param longitud Número de caracteres de la línea
+ * @param marca Marca a buscar, terminada en '\0'
+ * @return true si la marca aparece en la línea
+ */
+bool contieneMarca(const char* linea, int longitud, const char* marca);
+
+/**
+ * @brief Convierte una línea recibida en trama compacta o marca de control
+ * @param datos Primer carácter de la línea (no necesita terminar en '\0')
+ * @param longitud Número de caracteres de la línea
+ * @param trama Salida: trama, TRAMA_INICIO, TRAMA_FIN o TRAMA_INVALIDA
+ *              (con el código ErrorTrama como valor)
+ * @return false si la línea está vacía y debe ignorarse
+ * @details Las líneas "L,X" exactas, que son casi todo el tráfico, se
+ *          resuelven sin buscar las marcas ni pasar por analizarTrama
+ */
+bool clasificarLinea(const char* datos, int longitud, TramaCompacta& trama);
+
+/**
+ * @brief Obtiene una descripción legible de un código de error
+ * @param error Código de error
+ * @return Cadena constante con la descripción
+ */
+const char* descripcionErrorTrama(ErrorTrama error);
+
+/**
+ * @brief Parsea una línea del protocolo PRT-7
+ * @param linea Cadena recibida del puerto serial
+ * @return Puntero a TramaBase (TramaLoad o TramaMap) creado con new,
+ *         o nullptr si es inválida. El llamador debe liberarlo con delete.
+ * @details Formato esperado: "L,X" o "M,N"
+ */
+TramaBase* parsearTrama(const char* linea);
+
+/**
+ * @brief Parsea una línea del protocolo PRT-7 reservando la trama en una arena
+ * @param linea Cadena recibida del puerto serial
+ * @param arena Arena donde se construye la trama
+ * @return Puntero a TramaBase o nullptr si es inválida. No debe liberarse
+ *         con delete; deja de ser válida con arena.reiniciar().
+ */
+TramaBase* parsearTrama(const char* linea, ArenaTramas& arena);
+
+/**
+ * @brief Parsea una línea de longitud conocida reservando la trama en una arena
+ * @param datos Primer carácter de la línea
+ * @param longitud Número de caracteres de la línea
+ * @param arena Arena donde se construye la trama
+ * @param error Si no es nullptr, recibe el código de error del análisis
+ * @return Puntero a TramaBase o nullptr si es inválida
+ */
+TramaBase* parsearTrama(const char* datos, size_t longitud, ArenaTramas& arena,
+                        ErrorTrama* error = nullptr);
+
+#endif // PARSER_TRAMAS_H
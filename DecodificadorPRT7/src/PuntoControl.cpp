@@ -0,0 +1,269 @@
+/**
+ * @file PuntoControl.cpp
+ * @brief Implementación de las instantáneas del decodificador
+ */
+
+#include "PuntoControl.h"
+#include "RotorDeMapeo.h"
+#include <cstring>
+
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+/// Firma al inicio de cada registro
+static const char FIRMA_CONTROL[4] = { 'P', 'C', 'K', '2' };
+
+/// Capacidad inicial del búfer de registro
+static const size_t CAPACIDAD_REGISTRO_INICIAL = 4096;
+
+/// Posición de la huella del rotor dentro de la cabecera
+static const size_t POSICION_HUELLA_CONTROL = 36;
+
+/// Posición de la suma dentro de la cabecera
+static const size_t POSICION_SUMA_CONTROL = 40;
+
+/**
+ * @brief Escribe un entero little-endian de n bytes
+ */
+static void escribirLE(unsigned char* destino, unsigned long long valor, int n) {
+    for (int i = 0; i < n; i++) {
+        destino[i] = (unsigned char)(valor >> (8 * i));
+    }
+}
+
+/**
+ * @brief Lee un entero little-endian de n bytes
+ */
+static unsigned long long leerLE(const unsigned char* origen, int n) {
+    unsigned long long valor = 0;
+    for (int i = 0; i < n; i++) {
+        valor |= (unsigned long long)origen[i] << (8 * i);
+    }
+    return valor;
+}
+
+/**
+ * @brief Continúa una suma FNV-1a de 32 bits
+ */
+static unsigned int sumarFNV(unsigned int suma, const unsigned char* datos, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        suma ^= datos[i];
+        suma *= 16777619u;
+    }
+    return suma;
+}
+
+/// Valor inicial de la suma FNV-1a
+static const unsigned int FNV_INICIAL = 2166136261u;
+
+unsigned int huellaRotor(const RotorDeMapeo& rotor) {
+    const int tamano = rotor.getTamano();
+    unsigned char datos[2 + 2 * RotorDeMapeo::TAMANO_MAXIMO];
+    size_t n = 0;
+
+    datos[n++] = (unsigned char)(tamano - 1);
+    datos[n++] = rotor.getPlegarMayusculas() ? 1 : 0;
+    for (int i = 0; i < tamano; i++) {
+        datos[n++] = (unsigned char)rotor.getSimbolo(i);
+    }
+    for (int i = 0; i < tamano; i++) {
+        datos[n++] = (unsigned char)rotor.getContacto(i);
+    }
+    return sumarFNV(FNV_INICIAL, datos, n);
+}
+
+/**
+ * @brief Recorta el archivo a una longitud (descarta un registro cortado)
+ */
+static bool recortarArchivo(FILE* archivo, long long longitud) {
+#ifdef _WIN32
+    return _chsize_s(_fileno(archivo), longitud) == 0;
+#else
+    return ftruncate(fileno(archivo), (off_t)longitud) == 0;
+#endif
+}
+
+// ============ ESCRITOR ============
+
+PuntoControl::PuntoControl(int lotesPorSync)
+    : archivo(nullptr), registro(new char[CAPACIDAD_REGISTRO_INICIAL]),
+      capacidadRegistro(CAPACIDAD_REGISTRO_INICIAL), usadoRegistro(0),
+      lotesPorSync(lotesPorSync > 0 ? lotesPorSync : 1), sinSincronizar(0),
+      instantaneas(0), error(false) {
+}
+
+PuntoControl::~PuntoControl() {
+    cerrar();
+    delete[] registro;
+}
+
+bool PuntoControl::abrir(const char* ruta, const ListaDeCarga& carga, long long longitudValida) {
+    cerrar();
+
+    // "r+b" conserva el contenido; si el archivo no existe se crea
+    archivo = fopen(ruta, "r+b");
+    if (archivo == nullptr) {
+        archivo = fopen(ruta, "w+b");
+    }
+    if (archivo == nullptr) {
+        return false;
+    }
+
+    if (!recortarArchivo(archivo, longitudValida) || fseek(archivo, 0, SEEK_END) != 0) {
+        fclose(archivo);
+        archivo = nullptr;
+        return false;
+    }
+
+    cursor = carga.cursorAlFinal();
+    sinSincronizar = 0;
+    error = false;
+    return true;
+}
+
+void PuntoControl::agregarTramo(const char* datos, int cantidad, void* contexto) {
+    PuntoControl* control = static_cast<PuntoControl*>(contexto);
+
+    size_t necesario = control->usadoRegistro + cantidad;
+    if (necesario > control->capacidadRegistro) {
+        size_t capacidad = control->capacidadRegistro * 2;
+        while (capacidad < necesario) capacidad *= 2;
+
+        char* nuevo = new char[capacidad];
+        memcpy(nuevo, control->registro, control->usadoRegistro);
+        delete[] control->registro;
+        control->registro = nuevo;
+        control->capacidadRegistro = capacidad;
+    }
+
+    memcpy(control->registro + control->usadoRegistro, datos, cantidad);
+    control->usadoRegistro += cantidad;
+}
+
+bool PuntoControl::guardar(const ListaDeCarga& carga, const RotorDeMapeo& rotor,
+                           long long tramasRecibidas, long long tramasInvalidas) {
+    if (archivo == nullptr) {
+        return false;
+    }
+
+    // Armar el registro completo en memoria: cabecera y caracteres nuevos
+    usadoRegistro = TAM_CABECERA_CONTROL;
+    size_t nuevos = carga.recorrerNuevos(cursor, agregarTramo, this);
+
+    unsigned char* cabecera = (unsigned char*)registro;
+    memcpy(cabecera, FIRMA_CONTROL, 4);
+    escribirLE(cabecera + 4, (unsigned long long)rotor.getDesplazamiento(), 4);
+    escribirLE(cabecera + 8, (unsigned long long)tramasRecibidas, 8);
+    escribirLE(cabecera + 16, (unsigned long long)tramasInvalidas, 8);
+    escribirLE(cabecera + 24, (unsigned long long)carga.getTamano(), 8);
+    escribirLE(cabecera + 32, (unsigned long long)nuevos, 4);
+    escribirLE(cabecera + POSICION_HUELLA_CONTROL, huellaRotor(rotor), 4);
+
+    unsigned int suma = sumarFNV(FNV_INICIAL, cabecera, POSICION_SUMA_CONTROL);
+    suma = sumarFNV(suma, cabecera + TAM_CABECERA_CONTROL, nuevos);
+    escribirLE(cabecera + POSICION_SUMA_CONTROL, suma, 4);
+
+    // Un solo fwrite por instantánea y fflush para que sobreviva al proceso
+    if (fwrite(registro, 1, usadoRegistro, archivo) != usadoRegistro || fflush(archivo) != 0) {
+        error = true;
+    }
+    instantaneas++;
+
+    if (++sinSincronizar >= lotesPorSync) {
+        sincronizar();
+    }
+    return !error;
+}
+
+bool PuntoControl::sincronizar() {
+    if (archivo == nullptr || sinSincronizar == 0) {
+        return !error;
+    }
+
+#ifdef _WIN32
+    if (fflush(archivo) != 0 || _commit(_fileno(archivo)) != 0) {
+#else
+    if (fflush(archivo) != 0 || fsync(fileno(archivo)) != 0) {
+#endif
+        error = true;
+    }
+    sinSincronizar = 0;
+    return !error;
+}
+
+void PuntoControl::cerrar() {
+    if (archivo == nullptr) return;
+
+    sincronizar();
+    fclose(archivo);
+    archivo = nullptr;
+}
+
+// ============ CARGADOR ============
+
+ResultadoControl cargarPuntoControl(const char* ruta, ListaDeCarga& carga,
+                                    RotorDeMapeo& rotor, EstadoControl& estado) {
+    memset(&estado, 0, sizeof(estado));
+
+    FILE* archivo = fopen(ruta, "rb");
+    if (archivo == nullptr) {
+        return CONTROL_VACIO;
+    }
+
+    const unsigned int huella = huellaRotor(rotor);
+    ResultadoControl resultado = CONTROL_VACIO;
+
+    size_t capacidad = CAPACIDAD_REGISTRO_INICIAL;
+    char* caracteres = new char[capacidad];
+    unsigned char cabecera[TAM_CABECERA_CONTROL];
+
+    while (fread(cabecera, 1, TAM_CABECERA_CONTROL, archivo) == TAM_CABECERA_CONTROL) {
+        if (memcmp(cabecera, FIRMA_CONTROL, 4) != 0) break;
+
+        unsigned long long total = leerLE(cabecera + 24, 8);
+        size_t nuevos = (size_t)leerLE(cabecera + 32, 4);
+
+        // Cada registro continúa exactamente donde terminó el anterior
+        if (total != (unsigned long long)estado.caracteres + nuevos) break;
+
+        if (nuevos > capacidad) {
+            delete[] caracteres;
+            capacidad = nuevos;
+            caracteres = new char[capacidad];
+        }
+        if (fread(caracteres, 1, nuevos, archivo) != nuevos) break;
+
+        unsigned int suma = sumarFNV(FNV_INICIAL, cabecera, POSICION_SUMA_CONTROL);
+        suma = sumarFNV(suma, (const unsigned char*)caracteres, nuevos);
+        if (suma != (unsigned int)leerLE(cabecera + POSICION_SUMA_CONTROL, 4)) break;
+
+        // Registro íntegro pero de otro rotor: el desplazamiento no sirve
+        if ((unsigned int)leerLE(cabecera + POSICION_HUELLA_CONTROL, 4) != huella) {
+            resultado = CONTROL_INCOMPATIBLE;
+            break;
+        }
+
+        // Registro válido
+        carga.insertarBloque(caracteres, nuevos);
+        estado.desplazamiento = (int)leerLE(cabecera + 4, 4);
+        estado.tramasRecibidas = (long long)leerLE(cabecera + 8, 8);
+        estado.tramasInvalidas = (long long)leerLE(cabecera + 16, 8);
+        estado.caracteres = (long long)total;
+        estado.instantaneas++;
+        estado.bytesValidos += TAM_CABECERA_CONTROL + nuevos;
+    }
+
+    delete[] caracteres;
+    fclose(archivo);
+
+    if (resultado == CONTROL_INCOMPATIBLE || estado.instantaneas == 0) {
+        return resultado;
+    }
+
+    // El rotor recién creado está en 0: rotar hasta el desplazamiento guardado
+    rotor.rotar(estado.desplazamiento);
+    return CONTROL_CARGADO;
+}
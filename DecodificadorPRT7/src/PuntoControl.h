@@ -0,0 +1,167 @@
+/**
+ * @file PuntoControl.h
+ * @brief Instantáneas del estado del decodificador para reanudar sesiones
+ * @details El archivo de control sólo crece: cada instantánea agrega un
+ *          registro con el desplazamiento del rotor, los contadores de
+ *          tramas y los caracteres decodificados desde la instantánea
+ *          anterior. Así el costo de cada instantánea es proporcional a lo
+ *          nuevo, no al mensaje completo.
+ *
+ *          Registro (enteros little-endian):
+ *            0  "PCK2"
+ *            4  u32 desplazamiento del rotor
+ *            8  u64 tramas válidas procesadas (número de secuencia)
+ *           16  u64 líneas rechazadas
+ *           24  u64 caracteres decodificados en total
+ *           32  u32 caracteres nuevos (n)
+ *           36  u32 huella del rotor (FNV-1a del alfabeto, el cableado y
+ *               el plegado de mayúsculas)
+ *           40  u32 FNV-1a de los bytes 0..39 y de los caracteres nuevos
+ *           44  n caracteres nuevos
+ *
+ *          Un registro cortado por una caída se detecta con la suma y se
+ *          descarta al reanudar. El desplazamiento sólo tiene sentido con
+ *          el mismo rotor, así que no se reanuda si la huella no coincide.
+ */
+
+#ifndef PUNTO_CONTROL_H
+#define PUNTO_CONTROL_H
+
+#include <cstdio>
+#include "ListaDeCarga.h"
+
+class RotorDeMapeo;
+
+/// Bytes fijos de cada registro antes de los caracteres
+#define TAM_CABECERA_CONTROL 44
+
+/// Instantáneas entre dos fsync por defecto
+#define INSTANTANEAS_POR_SYNC 8
+
+/**
+ * @enum ResultadoControl
+ * @brief Resultado de cargarPuntoControl
+ */
+enum ResultadoControl {
+    CONTROL_CARGADO,     ///< Se recuperó la última instantánea válida
+    CONTROL_VACIO,       ///< No existe el archivo o no tiene instantáneas válidas
+    CONTROL_INCOMPATIBLE ///< Instantánea de otro rotor (alfabeto o cableado)
+};
+
+/**
+ * @struct EstadoControl
+ * @brief Estado recuperado de la última instantánea válida
+ */
+struct EstadoControl {
+    int desplazamiento;         ///< Desplazamiento del rotor
+    long long tramasRecibidas;  ///< Tramas válidas procesadas
+    long long tramasInvalidas;  ///< Líneas rechazadas
+    long long caracteres;       ///< Caracteres del mensaje recuperado
+    long long instantaneas;     ///< Registros válidos leídos
+    long long bytesValidos;     ///< Longitud del archivo hasta el último registro válido
+};
+
+/**
+ * @class PuntoControl
+ * @brief Escritor de instantáneas con fsync por lotes
+ * @details fflush entrega cada instantánea al sistema operativo (sobrevive
+ *          a la caída del proceso); fsync, que la lleva al disco, se hace
+ *          sólo cada lotesPorSync instantáneas o al pedirlo explícitamente.
+ */
+class PuntoControl {
+private:
+    FILE* archivo;              ///< Archivo de control abierto para agregar
+    CursorCarga cursor;         ///< Caracteres ya guardados
+    char* registro;             ///< Búfer donde se arma cada registro
+    size_t capacidadRegistro;   ///< Capacidad de registro
+    size_t usadoRegistro;       ///< Bytes armados en registro
+    int lotesPorSync;           ///< Instantáneas entre dos fsync
+    int sinSincronizar;         ///< Instantáneas escritas desde el último fsync
+    long long instantaneas;     ///< Instantáneas escritas en esta ejecución
+    bool error;                 ///< Falló alguna escritura
+
+public:
+    /**
+     * @brief Constructor
+     * @param lotesPorSync Instantáneas entre dos fsync
+     */
+    explicit PuntoControl(int lotesPorSync = INSTANTANEAS_POR_SYNC);
+
+    /**
+     * @brief Destructor: sincroniza y cierra el archivo
+     */
+    ~PuntoControl();
+
+    PuntoControl(const PuntoControl&) = delete;
+    PuntoControl& operator=(const PuntoControl&) = delete;
+
+    /**
+     * @brief Abre el archivo de control para seguir agregando instantáneas
+     * @param ruta Archivo de control
+     * @param carga Lista actual; sólo se guardará lo que se agregue después
+     * @param longitudValida Bytes a conservar del archivo (0 = empezar de
+     *                       nuevo; al reanudar, EstadoControl::bytesValidos)
+     * @return true si se pudo abrir
+     */
+    bool abrir(const char* ruta, const ListaDeCarga& carga, long long longitudValida);
+
+    /**
+     * @brief Agrega una instantánea del estado actual
+     * @param carga Mensaje decodificado
+     * @param rotor Rotor de mapeo
+     * @param tramasRecibidas Tramas válidas procesadas
+     * @param tramasInvalidas Líneas rechazadas
+     * @return true si se escribió correctamente
+     */
+    bool guardar(const ListaDeCarga& carga, const RotorDeMapeo& rotor,
+                 long long tramasRecibidas, long long tramasInvalidas);
+
+    /**
+     * @brief Fuerza el fsync de las instantáneas pendientes
+     * @return true si no hubo errores
+     */
+    bool sincronizar();
+
+    /**
+     * @brief Sincroniza y cierra el archivo
+     */
+    void cerrar();
+
+    /**
+     * @brief Obtiene las instantáneas escritas en esta ejecución
+     * @return Número de instantáneas
+     */
+    long long getInstantaneas() const { return instantaneas; }
+
+private:
+    /**
+     * @brief Agrega bytes al registro en construcción (crece si hace falta)
+     */
+    static void agregarTramo(const char* datos, int cantidad, void* contexto);
+};
+
+/**
+ * @brief Calcula la huella del alfabeto, el cableado y el plegado de un rotor
+ * @param rotor Rotor a identificar (la posición de la cabeza no influye)
+ * @return FNV-1a de 32 bits de la configuración
+ */
+unsigned int huellaRotor(const RotorDeMapeo& rotor);
+
+/**
+ * @brief Reconstruye el estado a partir de un archivo de control
+ * @param ruta Archivo de control
+ * @param carga Lista vacía donde se recupera el mensaje
+ * @param rotor Rotor recién creado y ya cableado; se rota al desplazamiento
+ *              guardado
+ * @param estado Salida: contadores de la última instantánea válida
+ * @return CONTROL_CARGADO, CONTROL_VACIO si el archivo no existe o no tiene
+ *         ninguna instantánea válida, o CONTROL_INCOMPATIBLE si una
+ *         instantánea válida es de otro rotor (carga y rotor pueden quedar
+ *         a medias y no deben usarse)
+ * @details Lee los registros en orden y se detiene en el primero cortado o
+ *          dañado; los posteriores se ignoran
+ */
+ResultadoControl cargarPuntoControl(const char* ruta, ListaDeCarga& carga,
+                                    RotorDeMapeo& rotor, EstadoControl& estado);
+
+#endif // PUNTO_CONTROL_H
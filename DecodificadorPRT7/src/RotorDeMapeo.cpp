@@ -6,16 +6,38 @@
 #include "RotorDeMapeo.h"
 #include <cstdio>
 #include <cctype>
+#include <cstring>
 
-RotorDeMapeo::RotorDeMapeo() : cabeza(nullptr), tamano(0) {
-    // Crear nodos para A-Z y espacio
-    const char alfabeto[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ ";
+RotorDeMapeo::RotorDeMapeo()
+    : cabeza(nullptr), tamano(0), plegarMayusculas(true), desplazamiento(0),
+      tablasMapeo(nullptr), tablasInversas(nullptr) {
+    construirLista(ALFABETO_PRT7, sizeof(ALFABETO_PRT7) - 1);
+}
+
+RotorDeMapeo::RotorDeMapeo(const char* alfabeto, bool plegarMayusculas)
+    : cabeza(nullptr), tamano(0), plegarMayusculas(plegarMayusculas), desplazamiento(0),
+      tablasMapeo(nullptr), tablasInversas(nullptr) {
+    construirLista(alfabeto, alfabeto != nullptr ? (int)strlen(alfabeto) : 0);
+}
+
+RotorDeMapeo::RotorDeMapeo(const char* simbolos, int cantidad, bool plegarMayusculas)
+    : cabeza(nullptr), tamano(0), plegarMayusculas(plegarMayusculas), desplazamiento(0),
+      tablasMapeo(nullptr), tablasInversas(nullptr) {
+    construirLista(simbolos, cantidad);
+}
+
+void RotorDeMapeo::construirLista(const char* simbolos, int cantidad) {
     NodoRotor* primero = nullptr;
     NodoRotor* ultimo = nullptr;
+    bool presente[256] = { false };
 
     // Construir la lista circular
-    for (int i = 0; alfabeto[i] != '\0'; i++) {
-        NodoRotor* nuevo = new NodoRotor(alfabeto[i]);
+    for (int i = 0; i < cantidad && tamano < TAMANO_MAXIMO; i++) {
+        unsigned char c = (unsigned char)simbolos[i];
+        if (presente[c]) continue;
+        presente[c] = true;
+
+        NodoRotor* nuevo = new NodoRotor((char)c);
 
         if (primero == nullptr) {
             // Primer nodo
@@ -36,9 +58,13 @@ RotorDeMapeo::RotorDeMapeo() : cabeza(nullptr), tamano(0) {
         ultimo->siguiente = primero;
         primero->previo = ultimo;
     }
+
+    construirTablas();
 }
 
 RotorDeMapeo::~RotorDeMapeo() {
+    delete[] tablasMapeo;
+
     if (cabeza == nullptr) return;
 
     // Romper el círculo temporalmente
@@ -54,90 +80,153 @@ RotorDeMapeo::~RotorDeMapeo() {
     }
 }
 
-void RotorDeMapeo::rotar(int n) {
-    if (cabeza == nullptr || n == 0) return;
-
-    // Normalizar la rotación al rango del tamaño
-    n = n % tamano;
-    if (n < 0) n += tamano;
-
-    // Mover la cabeza n posiciones
-    for (int i = 0; i < n; i++) {
-        cabeza = cabeza->siguiente;
+void RotorDeMapeo::construirTablas() {
+    for (int i = 0; i < 256; i++) {
+        indices[i] = -1;
     }
-}
-
-NodoRotor* RotorDeMapeo::buscarNodo(char c) const {
-    if (cabeza == nullptr) return nullptr;
-
-    // Convertir a mayúscula para búsqueda
-    char buscar = toupper(c);
+    desplazamiento = 0;
 
+    // Recorrer la lista una sola vez desde cabeza (índice 0)
     NodoRotor* actual = cabeza;
-    do {
-        if (actual->dato == buscar) {
-            return actual;
-        }
+    int i = 0;
+    while (actual != nullptr && i < TAMANO_MAXIMO) {
+        simbolos[i] = actual->dato;
+        nodos[i] = actual;
+        indices[(unsigned char)actual->dato] = (signed short)i;
         actual = actual->siguiente;
-    } while (actual != cabeza);
+        i++;
+        if (actual == cabeza) break;
+    }
+
+    // La búsqueda original convierte a mayúscula: registrar las minúsculas
+    // con el índice de su mayúscula correspondiente
+    for (int c = 0; plegarMayusculas && c < 256; c++) {
+        int mayuscula = toupper(c);
+        if (indices[c] < 0 && indices[mayuscula] >= 0) {
+            indices[c] = indices[mayuscula];
+        }
+    }
 
-    return nullptr;
+    reiniciarCableado();
 }
 
-int RotorDeMapeo::calcularDistancia(NodoRotor* desde, NodoRotor* hasta) const {
-    if (desde == nullptr || hasta == nullptr) return 0;
+void RotorDeMapeo::reiniciarCableado() {
+    for (int i = 0; i < tamano; i++) {
+        cableado[i] = (unsigned char)i;
+        cableadoInverso[i] = (unsigned char)i;
+    }
+    construirTablasMapeo();
+}
 
-    int distancia = 0;
-    NodoRotor* actual = desde;
+bool RotorDeMapeo::setCableado(const char* permutacion, int cantidad) {
+    if (permutacion == nullptr || cantidad != tamano) return false;
 
-    while (actual != hasta) {
-        actual = actual->siguiente;
-        distancia++;
+    unsigned char nuevo[TAMANO_MAXIMO];
+    unsigned char inverso[TAMANO_MAXIMO];
+    bool usado[TAMANO_MAXIMO] = { false };
 
-        // Prevención de bucle infinito
-        if (distancia > tamano) return 0;
+    for (int i = 0; i < cantidad; i++) {
+        // Sólo símbolos exactos del alfabeto (no minúsculas plegadas), sin repetir
+        int indice = indices[(unsigned char)permutacion[i]];
+        if (indice < 0 || simbolos[indice] != permutacion[i] || usado[indice]) {
+            return false;
+        }
+        usado[indice] = true;
+        nuevo[i] = (unsigned char)indice;
+        inverso[indice] = (unsigned char)i;
     }
 
-    return distancia;
+    memcpy(cableado, nuevo, tamano);
+    memcpy(cableadoInverso, inverso, tamano);
+    construirTablasMapeo();
+    return true;
 }
 
-char RotorDeMapeo::getMapeo(char entrada) const {
-    if (cabeza == nullptr) return entrada;
+void RotorDeMapeo::construirTablasMapeo() {
+    // Precalcular el mapeo de los 256 bytes para cada desplazamiento, en
+    // ambos sentidos (un rotor vacío conserva una tabla identidad para el
+    // desplazamiento 0)
+    int numTablas = tamano > 0 ? tamano : 1;
+    delete[] tablasMapeo;
+    tablasMapeo = new unsigned char[2 * numTablas * 256];
+    tablasInversas = tablasMapeo + numTablas * 256;
+
+    for (int d = 0; d < numTablas; d++) {
+        for (int c = 0; c < 256; c++) {
+            tablasMapeo[d * 256 + c] = (unsigned char)calcularMapeo((char)c, d, cableado);
+            tablasInversas[d * 256 + c] = (unsigned char)calcularMapeo((char)c, d, cableadoInverso);
+        }
+    }
+}
 
-    // Convertir entrada a mayúscula
-    char buscar = toupper(entrada);
+char RotorDeMapeo::calcularMapeo(char entrada, int desp, const unsigned char* permutacion) const {
+    int indice = indices[(unsigned char)entrada];
+    if (indice < 0) return entrada;
 
-    // Buscar el nodo con el carácter de entrada
-    NodoRotor* nodoEntrada = buscarNodo(buscar);
-    if (nodoEntrada == nullptr) {
-        // Si no se encuentra, devolver el mismo carácter
-        return entrada;
-    }
+    // Contacto por el que entra el símbolo con la cabeza en desp
+    int contacto = indice + desp;
+    if (contacto >= tamano) contacto -= tamano;
 
-    // Calcular la distancia desde cabeza hasta el nodo de entrada
-    int distancia = calcularDistancia(cabeza, nodoEntrada);
+    // El cableado lo lleva a otro contacto; se deshace el desplazamiento
+    int destino = permutacion[contacto] - desp;
+    if (destino < 0) destino += tamano;
+    return simbolos[destino];
+}
 
-    // El carácter mapeado está a la misma distancia desde cabeza
-    // (esto implementa el cifrado César circular)
-    NodoRotor* resultado = cabeza;
-    for (int i = 0; i < distancia; i++) {
-        resultado = resultado->siguiente;
-    }
+void RotorDeMapeo::rotar(int n) {
+    if (cabeza == nullptr || n == 0) return;
 
-    return resultado->dato;
+    // Normalizar la rotación al rango del tamaño
+    n = n % tamano;
+    if (n < 0) n += tamano;
+
+    // Mover la cabeza n posiciones sin recorrer la lista
+    desplazamiento += n;
+    if (desplazamiento >= tamano) desplazamiento -= tamano;
+    cabeza = nodos[desplazamiento];
 }
 
 void RotorDeMapeo::imprimirEstado() const {
+    EscritorSalida salida(stdout, TAM_BUFFER_CONSOLA);
+    imprimirEstado(salida, SALIDA_CRUDA);
+}
+
+void RotorDeMapeo::imprimirEstado(EscritorSalida& salida, FormatoSalida formato) const {
     if (cabeza == nullptr) {
-        printf("Rotor vacío\n");
+        if (formato == SALIDA_NDJSON) {
+            salida.escribirCadena("{\"rotor\":null}\n");
+        } else {
+            salida.escribirCadena("Rotor vacío\n");
+        }
         return;
     }
 
-    printf("Estado del Rotor (cabeza='%c'): ", cabeza->dato);
-    NodoRotor* actual = cabeza;
-    do {
-        printf("%c", actual->dato);
-        actual = actual->siguiente;
-    } while (actual != cabeza);
-    printf("\n");
+    // Los símbolos en orden desde la cabeza están contiguos en la tabla
+    switch (formato) {
+    case SALIDA_CRUDA:
+        salida.escribirFormato("Estado del Rotor (cabeza='%c'): ", cabeza->dato);
+        salida.escribir(simbolos + desplazamiento, tamano - desplazamiento);
+        salida.escribir(simbolos, desplazamiento);
+        salida.escribirCaracter('\n');
+        break;
+
+    case SALIDA_CORCHETES:
+        for (int i = 0; i < tamano; i++) {
+            int k = desplazamiento + i < tamano ? desplazamiento + i : desplazamiento + i - tamano;
+            salida.escribirCaracter('[');
+            salida.escribirCaracter(simbolos[k]);
+            salida.escribirCaracter(']');
+        }
+        salida.escribirCaracter('\n');
+        break;
+
+    case SALIDA_NDJSON:
+        salida.escribirCadena("{\"cabeza\":\"");
+        salida.escribirJSON(&cabeza->dato, 1);
+        salida.escribirFormato("\",\"desplazamiento\":%d,\"simbolos\":\"", desplazamiento);
+        salida.escribirJSON(simbolos + desplazamiento, tamano - desplazamiento);
+        salida.escribirJSON(simbolos, desplazamiento);
+        salida.escribirCadena("\"}\n");
+        break;
+    }
 }
\ No newline at end of file
@@ -6,6 +6,12 @@
 #ifndef ROTOR_DE_MAPEO_H
 #define ROTOR_DE_MAPEO_H
 
+#include <cstring>
+#include "EscritorSalida.h"
+
+/// Alfabeto del protocolo PRT-7: A-Z y espacio
+static constexpr char ALFABETO_PRT7[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ ";
+
 /**
  * @struct NodoRotor
  * @brief Nodo de la lista circular que contiene un carácter
@@ -26,43 +32,103 @@ struct NodoRotor {
  * @class RotorDeMapeo
  * @brief Implementa un disco de cifrado mediante lista circular doblemente enlazada
  * @details Similar a una Rueda de César, mapea caracteres según su rotación actual.
- *          Contiene el alfabeto A-Z y un puntero cabeza que indica la posición 'cero'.
+ *          Por defecto contiene el alfabeto A-Z y espacio; también admite
+ *          cualquier conjunto de hasta 256 bytes elegido en tiempo de
+ *          ejecución. Un puntero cabeza indica la posición 'cero'.
+ *          Para alfabetos conocidos al compilar, RotorFijo (RotorFijo.h)
+ *          ofrece la misma interfaz con tablas constexpr.
+ *
+ *          El mapeo sigue un cableado (permutación del alfabeto) como un
+ *          rotor Enigma: el símbolo de índice i entra por el contacto
+ *          (i + desp) mod tamano, el cableado lo lleva al contacto w y sale
+ *          como el símbolo de índice (w - desp) mod tamano. El cableado por
+ *          defecto es la identidad, que deja cada carácter sin cambios.
+ *          Las tablas directa e inversa se precalculan para cada
+ *          desplazamiento, así que ambos sentidos son O(1).
  */
 class RotorDeMapeo {
+public:
+    static const int TAMANO_MAXIMO = 256; ///< Máximo de símbolos en el rotor
+
 private:
     NodoRotor* cabeza; ///< Puntero a la posición 'cero' actual del rotor
     int tamano;        ///< Número de elementos en el rotor
+    bool plegarMayusculas; ///< Las minúsculas se mapean como su mayúscula
+
+    int desplazamiento;                   ///< Índice de cabeza dentro del alfabeto
+    signed short indices[256];            ///< Tabla carácter -> índice (-1 si no existe)
+    char simbolos[TAMANO_MAXIMO];         ///< Tabla índice -> carácter
+    NodoRotor* nodos[TAMANO_MAXIMO];      ///< Tabla índice -> nodo de la lista
+    unsigned char cableado[TAMANO_MAXIMO]; ///< Contacto de entrada -> contacto de salida
+    unsigned char cableadoInverso[TAMANO_MAXIMO]; ///< Inversa de cableado
+    unsigned char* tablasMapeo;           ///< tamano tablas de 256 bytes, una por desplazamiento
+    unsigned char* tablasInversas;        ///< Ídem para el sentido inverso (mismo bloque que tablasMapeo)
+
+    /**
+     * @brief Crea la lista circular con los símbolos dados
+     * @param simbolos Símbolos en orden (se ignoran los repetidos)
+     * @param cantidad Número de símbolos (se usan a lo sumo TAMANO_MAXIMO)
+     */
+    void construirLista(const char* simbolos, int cantidad);
 
     /**
-     * @brief Encuentra un nodo por su carácter
-     * @param c Carácter a buscar
-     * @return Puntero al nodo encontrado o nullptr
+     * @brief Reconstruye las tablas de consulta a partir de la lista circular
+     * @details La lista sigue siendo el modelo canónico; las tablas sólo
+     *          cachean su contenido para que rotar y mapear sean O(1)
      */
-    NodoRotor* buscarNodo(char c) const;
+    void construirTablas();
 
     /**
-     * @brief Calcula la distancia entre dos nodos
-     * @param desde Nodo de inicio
-     * @param hasta Nodo de destino
-     * @return Distancia en número de nodos
+     * @brief Precalcula las tablas directa e inversa a partir del cableado
      */
-    int calcularDistancia(NodoRotor* desde, NodoRotor* hasta) const;
+    void construirTablasMapeo();
+
+    /**
+     * @brief Calcula el mapeo de un carácter recorriendo las tablas de índices
+     * @param entrada Carácter a mapear
+     * @param desp Desplazamiento de cabeza a usar
+     * @param permutacion cableado (sentido directo) o cableadoInverso
+     * @return Carácter mapeado
+     * @details Se usa sólo para precalcular tablasMapeo y tablasInversas
+     */
+    char calcularMapeo(char entrada, int desp, const unsigned char* permutacion) const;
 
 public:
     /**
-     * @brief Constructor que inicializa el rotor con A-Z
+     * @brief Constructor que inicializa el rotor con ALFABETO_PRT7
+     * @details Las minúsculas se pliegan a mayúsculas, como exige el protocolo
      */
     RotorDeMapeo();
 
+    /**
+     * @brief Constructor con un alfabeto elegido en tiempo de ejecución
+     * @param alfabeto Símbolos en orden, terminados en '\0'
+     * @param plegarMayusculas true para mapear las minúsculas como su
+     *                         mayúscula cuando sólo ésta está en el alfabeto
+     */
+    explicit RotorDeMapeo(const char* alfabeto, bool plegarMayusculas = false);
+
+    /**
+     * @brief Constructor con un alfabeto de bytes arbitrarios (puede incluir '\0')
+     * @param simbolos Símbolos en orden (se ignoran los repetidos)
+     * @param cantidad Número de símbolos (a lo sumo TAMANO_MAXIMO)
+     * @param plegarMayusculas Igual que en el constructor anterior
+     */
+    RotorDeMapeo(const char* simbolos, int cantidad, bool plegarMayusculas);
+
     /**
      * @brief Destructor que libera toda la memoria
      */
     ~RotorDeMapeo();
 
+    RotorDeMapeo(const RotorDeMapeo&) = delete;
+    RotorDeMapeo& operator=(const RotorDeMapeo&) = delete;
+
     /**
      * @brief Rota el rotor N posiciones
      * @param n Número de posiciones (+ derecha, - izquierda)
-     * @details Mueve la cabeza circularmente sin mover los datos
+     * @details Mueve la cabeza circularmente sin mover los datos.
+     *          Es O(1): ajusta el desplazamiento y toma el nodo de la tabla.
      */
     void rotar(int n);
 
@@ -70,10 +136,81 @@ public:
      * @brief Mapea un carácter según la rotación actual
      * @param entrada Carácter a mapear
      * @return Carácter mapeado
-     * @details Encuentra el carácter de entrada, calcula su distancia a cabeza,
-     *          y devuelve el carácter que está a esa distancia desde cabeza
+     * @details Aplica el cableado con la cabeza en su posición actual;
+     *          los caracteres fuera del alfabeto no cambian
+     */
+    char getMapeo(char entrada) const { return mapearEn(entrada, desplazamiento); }
+
+    /**
+     * @brief Deshace el mapeo según la rotación actual
+     * @param salida Carácter mapeado
+     * @return Carácter c tal que getMapeo(c) == salida
+     */
+    char getInverso(char salida) const { return desmapearEn(salida, desplazamiento); }
+
+    /**
+     * @brief Mapea un carácter como si la cabeza estuviera en otra posición
+     * @param entrada Carácter a mapear
+     * @param desp Desplazamiento de cabeza a usar, en [0, tamano)
+     * @return Carácter mapeado
+     * @details Permite a los decodificadores por lotes llevar su propio
+     *          desplazamiento acumulado sin modificar el rotor
+     */
+    char mapearEn(char entrada, int desp) const {
+        return (char)tablasMapeo[desp * 256 + (unsigned char)entrada];
+    }
+
+    /**
+     * @brief Obtiene la tabla de mapeo completa para un desplazamiento
+     * @param desp Desplazamiento de cabeza, en [0, tamano)
+     * @return Tabla de 256 bytes: tabla[c] == mapearEn(c, desp)
+     * @details Pensada para los kernels que decodifican bloques de bytes
+     */
+    const unsigned char* getTablaMapeo(int desp) const { return tablasMapeo + desp * 256; }
+
+    /**
+     * @brief Deshace el mapeo como si la cabeza estuviera en otra posición
+     * @param salida Carácter mapeado
+     * @param desp Desplazamiento de cabeza a usar, en [0, tamano)
+     * @return Carácter c tal que mapearEn(c, desp) == salida
+     */
+    char desmapearEn(char salida, int desp) const {
+        return (char)tablasInversas[desp * 256 + (unsigned char)salida];
+    }
+
+    /**
+     * @brief Obtiene la tabla inversa completa para un desplazamiento
+     * @param desp Desplazamiento de cabeza, en [0, tamano)
+     * @return Tabla de 256 bytes: tabla[c] == desmapearEn(c, desp)
+     * @details Con ella los mismos kernels de bloques codifican
+     */
+    const unsigned char* getTablaInversa(int desp) const { return tablasInversas + desp * 256; }
+
+    /**
+     * @brief Cambia el cableado del rotor
+     * @param permutacion Los símbolos del alfabeto en el orden cableado: el
+     *                    contacto i se conecta al contacto del símbolo
+     *                    permutacion[i]
+     * @param cantidad Número de símbolos (debe ser getTamano())
+     * @return false si permutacion no es una permutación del alfabeto (el
+     *         cableado anterior se conserva)
+     * @details Recalcula las tablas; la posición de la cabeza no cambia
      */
-    char getMapeo(char entrada) const;
+    bool setCableado(const char* permutacion, int cantidad);
+
+    /**
+     * @brief Cambia el cableado del rotor
+     * @param permutacion Permutación del alfabeto terminada en '\0'
+     * @return false si no es una permutación del alfabeto
+     */
+    bool setCableado(const char* permutacion) {
+        return permutacion != nullptr && setCableado(permutacion, (int)strlen(permutacion));
+    }
+
+    /**
+     * @brief Vuelve al cableado identidad (ningún carácter cambia)
+     */
+    void reiniciarCableado();
 
     /**
      * @brief Obtiene el carácter en la posición cabeza
@@ -82,9 +219,49 @@ public:
     char getCabeza() const { return cabeza ? cabeza->dato : '\0'; }
 
     /**
-     * @brief Imprime el estado actual del rotor (debug)
+     * @brief Obtiene el desplazamiento actual de la cabeza
+     * @return Índice de cabeza dentro del alfabeto, en [0, tamano)
+     */
+    int getDesplazamiento() const { return desplazamiento; }
+
+    /**
+     * @brief Obtiene el número de símbolos del rotor
+     * @return Tamaño del alfabeto
+     */
+    int getTamano() const { return tamano; }
+
+    /**
+     * @brief Obtiene el símbolo de una posición del alfabeto
+     * @param indice Posición, en [0, tamano)
+     * @return Símbolo en esa posición
+     */
+    char getSimbolo(int indice) const { return simbolos[indice]; }
+
+    /**
+     * @brief Obtiene el contacto al que el cableado lleva un contacto
+     * @param contacto Contacto de entrada, en [0, tamano)
+     * @return Contacto de salida
+     */
+    int getContacto(int contacto) const { return cableado[contacto]; }
+
+    /**
+     * @brief Indica si las minúsculas se mapean como su mayúscula
+     * @return true si el rotor pliega mayúsculas
+     */
+    bool getPlegarMayusculas() const { return plegarMayusculas; }
+
+    /**
+     * @brief Imprime el estado actual del rotor en stdout (debug)
      */
     void imprimirEstado() const;
+
+    /**
+     * @brief Vuelca el estado del rotor en el formato indicado
+     * @param salida Escritor de destino (no se vacía)
+     * @param formato Texto, símbolos entre corchetes (la cabeza primero)
+     *                o una línea NDJSON
+     */
+    void imprimirEstado(EscritorSalida& salida, FormatoSalida formato) const;
 };
 
 #endif // ROTOR_DE_MAPEO_H
\ No newline at end of file
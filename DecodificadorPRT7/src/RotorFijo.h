@@ -0,0 +1,256 @@
+/**
+ * @file RotorFijo.h
+ * @brief Rotor de mapeo con el alfabeto fijado en tiempo de compilación
+ * @details Variante de RotorDeMapeo para alfabetos conocidos al compilar:
+ *          las tablas por desplazamiento (256 bytes cada una, como las de
+ *          RotorDeMapeo) se calculan como constexpr, así que un mapeo es
+ *          una sola lectura de una tabla en memoria de sólo lectura, sin
+ *          lista ni memoria dinámica, y el módulo de rotar() por el tamaño
+ *          del alfabeto es una constante que el compilador reduce a
+ *          multiplicación y desplazamiento.
+ *          Para alfabetos elegidos en tiempo de ejecución se usa
+ *          RotorDeMapeo, que produce los mismos resultados.
+ *
+ *          Un alfabeto es un tipo con TAMANO, PLEGAR_MAYUSCULAS,
+ *          simbolo(i) y cableado(i) (índice del símbolo al que se conecta
+ *          el contacto i; los alfabetos de este archivo usan la identidad).
+ */
+
+#ifndef ROTOR_FIJO_H
+#define ROTOR_FIJO_H
+
+#include "RotorDeMapeo.h"
+
+/**
+ * @struct AlfabetoPRT7
+ * @brief Alfabeto del protocolo: A-Z y espacio, con minúsculas plegadas
+ */
+struct AlfabetoPRT7 {
+    static constexpr int TAMANO = sizeof(ALFABETO_PRT7) - 1; ///< Símbolos
+    static constexpr bool PLEGAR_MAYUSCULAS = true;          ///< Minúsculas como mayúsculas
+
+    /// Símbolo en la posición i
+    static constexpr char simbolo(int i) { return ALFABETO_PRT7[i]; }
+
+    /// Contacto de salida del contacto i (cableado identidad)
+    static constexpr int cableado(int i) { return i; }
+};
+
+/**
+ * @struct AlfabetoASCII
+ * @brief Los 95 caracteres ASCII imprimibles (del espacio a '~')
+ */
+struct AlfabetoASCII {
+    static constexpr int TAMANO = 95;                ///< Símbolos
+    static constexpr bool PLEGAR_MAYUSCULAS = false; ///< Distingue mayúsculas
+
+    /// Símbolo en la posición i
+    static constexpr char simbolo(int i) { return (char)(' ' + i); }
+
+    /// Contacto de salida del contacto i (cableado identidad)
+    static constexpr int cableado(int i) { return i; }
+};
+
+/**
+ * @struct AlfabetoByte
+ * @brief Los 256 valores de un byte
+ */
+struct AlfabetoByte {
+    static constexpr int TAMANO = 256;               ///< Símbolos
+    static constexpr bool PLEGAR_MAYUSCULAS = false; ///< Distingue mayúsculas
+
+    /// Símbolo en la posición i
+    static constexpr char simbolo(int i) { return (char)i; }
+
+    /// Contacto de salida del contacto i (cableado identidad)
+    static constexpr int cableado(int i) { return i; }
+};
+
+/**
+ * @struct TablasRotorFijo
+ * @brief Tablas de consulta de un alfabeto, calculadas al compilar
+ * @tparam Alfabeto Tipo con TAMANO, PLEGAR_MAYUSCULAS, simbolo(i) y cableado(i)
+ */
+template <typename Alfabeto>
+struct TablasRotorFijo {
+    signed short indices[256];          ///< Carácter -> índice (-1 si no existe)
+    char simbolos[Alfabeto::TAMANO];    ///< Índice -> carácter
+    unsigned char cableado[Alfabeto::TAMANO]; ///< Contacto de entrada -> contacto de salida
+    unsigned char inverso[Alfabeto::TAMANO];  ///< Inversa de cableado
+    unsigned char mapeo[Alfabeto::TAMANO][256];   ///< Desplazamiento, carácter -> mapeado
+    unsigned char inversas[Alfabeto::TAMANO][256]; ///< Desplazamiento, mapeado -> carácter
+    bool repetidos;                     ///< El alfabeto tiene símbolos repetidos
+    bool cableadoInvalido;              ///< cableado(i) no es una permutación
+
+    /**
+     * @brief Aplica una permutación con la cabeza en desp
+     * @details Misma aritmética que RotorDeMapeo::calcularMapeo
+     */
+    constexpr unsigned char aplicar(int c, int desp, const unsigned char* permutacion) const {
+        int indice = indices[c];
+        if (indice < 0) return (unsigned char)c;
+
+        int contacto = indice + desp;
+        if (contacto >= Alfabeto::TAMANO) contacto -= Alfabeto::TAMANO;
+        int destino = permutacion[contacto] - desp;
+        if (destino < 0) destino += Alfabeto::TAMANO;
+        return (unsigned char)simbolos[destino];
+    }
+
+    constexpr TablasRotorFijo()
+        : indices(), simbolos(), cableado(), inverso(), mapeo(), inversas(),
+          repetidos(false), cableadoInvalido(false) {
+        bool usado[Alfabeto::TAMANO] = {};
+        for (int c = 0; c < 256; c++) {
+            indices[c] = -1;
+        }
+        for (int i = 0; i < Alfabeto::TAMANO; i++) {
+            unsigned char c = (unsigned char)Alfabeto::simbolo(i);
+            if (indices[c] >= 0) repetidos = true;
+            indices[c] = (signed short)i;
+            simbolos[i] = (char)c;
+        }
+
+        // Igual que RotorDeMapeo: la minúscula toma el índice de su mayúscula
+        // (en ASCII, como toupper en la configuración regional "C")
+        for (int c = 'a'; Alfabeto::PLEGAR_MAYUSCULAS && c <= 'z'; c++) {
+            if (indices[c] < 0) indices[c] = indices[c - 'a' + 'A'];
+        }
+
+        for (int i = 0; i < Alfabeto::TAMANO; i++) {
+            int w = Alfabeto::cableado(i);
+            if (w < 0 || w >= Alfabeto::TAMANO || usado[w]) {
+                cableadoInvalido = true;
+                continue;
+            }
+            usado[w] = true;
+            cableado[i] = (unsigned char)w;
+            inverso[w] = (unsigned char)i;
+        }
+
+        for (int desp = 0; desp < Alfabeto::TAMANO; desp++) {
+            for (int c = 0; c < 256; c++) {
+                mapeo[desp][c] = aplicar(c, desp, cableado);
+                inversas[desp][c] = aplicar(c, desp, inverso);
+            }
+        }
+    }
+};
+
+/**
+ * @class RotorFijo
+ * @brief Rotor con alfabeto fijo: misma interfaz de consulta que RotorDeMapeo
+ * @tparam Alfabeto Tipo con TAMANO (1-256), PLEGAR_MAYUSCULAS, simbolo(i)
+ *                  y cableado(i)
+ */
+template <typename Alfabeto>
+class RotorFijo {
+public:
+    static constexpr int TAMANO = Alfabeto::TAMANO; ///< Símbolos del rotor
+
+    static_assert(TAMANO > 0 && TAMANO <= RotorDeMapeo::TAMANO_MAXIMO,
+                  "El alfabeto debe tener entre 1 y 256 símbolos");
+
+private:
+    static constexpr TablasRotorFijo<Alfabeto> tablas = TablasRotorFijo<Alfabeto>(); ///< Tablas de consulta
+
+    static_assert(!tablas.repetidos, "El alfabeto tiene símbolos repetidos");
+    static_assert(!tablas.cableadoInvalido, "El cableado no es una permutación del alfabeto");
+
+    int desplazamiento; ///< Índice de cabeza dentro del alfabeto
+
+public:
+    /**
+     * @brief Constructor con la cabeza en el primer símbolo
+     */
+    RotorFijo() : desplazamiento(0) {}
+
+    /**
+     * @brief Rota el rotor N posiciones
+     * @param n Número de posiciones (+ derecha, - izquierda)
+     */
+    void rotar(int n) {
+        n %= TAMANO;
+        if (n < 0) n += TAMANO;
+        desplazamiento += n;
+        if (desplazamiento >= TAMANO) desplazamiento -= TAMANO;
+    }
+
+    /**
+     * @brief Mapea un carácter según la rotación actual
+     * @param entrada Carácter a mapear
+     * @return Carácter mapeado
+     */
+    char getMapeo(char entrada) const { return mapearEn(entrada, desplazamiento); }
+
+    /**
+     * @brief Mapea un carácter como si la cabeza estuviera en otra posición
+     * @param entrada Carácter a mapear
+     * @param desp Desplazamiento de cabeza a usar, en [0, TAMANO)
+     * @return Carácter mapeado (la entrada sin cambios si no está en el alfabeto)
+     */
+    static constexpr char mapearEn(char entrada, int desp) {
+        return (char)tablas.mapeo[desp][(unsigned char)entrada];
+    }
+
+    /**
+     * @brief Obtiene la tabla de mapeo completa para un desplazamiento
+     * @param desp Desplazamiento de cabeza, en [0, TAMANO)
+     * @return Tabla de 256 bytes, igual que RotorDeMapeo::getTablaMapeo
+     */
+    static constexpr const unsigned char* getTablaMapeo(int desp) { return tablas.mapeo[desp]; }
+
+    /**
+     * @brief Deshace el mapeo según la rotación actual
+     * @param salida Carácter mapeado
+     * @return Carácter c tal que getMapeo(c) == salida
+     */
+    char getInverso(char salida) const { return desmapearEn(salida, desplazamiento); }
+
+    /**
+     * @brief Deshace el mapeo como si la cabeza estuviera en otra posición
+     * @param salida Carácter mapeado
+     * @param desp Desplazamiento de cabeza a usar, en [0, TAMANO)
+     * @return Carácter c tal que mapearEn(c, desp) == salida
+     */
+    static constexpr char desmapearEn(char salida, int desp) {
+        return (char)tablas.inversas[desp][(unsigned char)salida];
+    }
+
+    /**
+     * @brief Obtiene la tabla inversa completa para un desplazamiento
+     * @param desp Desplazamiento de cabeza, en [0, TAMANO)
+     * @return Tabla de 256 bytes, igual que RotorDeMapeo::getTablaInversa
+     */
+    static constexpr const unsigned char* getTablaInversa(int desp) { return tablas.inversas[desp]; }
+
+    /**
+     * @brief Obtiene el índice de un carácter en el alfabeto
+     * @param c Carácter a buscar
+     * @return Índice o -1 si no pertenece al alfabeto
+     */
+    static constexpr int indiceDe(char c) { return tablas.indices[(unsigned char)c]; }
+
+    /**
+     * @brief Obtiene el carácter en la posición cabeza
+     * @return Carácter actual en cabeza
+     */
+    char getCabeza() const { return tablas.simbolos[desplazamiento]; }
+
+    /**
+     * @brief Obtiene el desplazamiento actual de cabeza
+     * @return Índice de cabeza en [0, TAMANO)
+     */
+    int getDesplazamiento() const { return desplazamiento; }
+
+    /**
+     * @brief Obtiene el tamaño del rotor
+     * @return Número de elementos
+     */
+    static constexpr int getTamano() { return TAMANO; }
+};
+
+template <typename Alfabeto>
+constexpr TablasRotorFijo<Alfabeto> RotorFijo<Alfabeto>::tablas;
+
+#endif // ROTOR_FIJO_H
@@ -4,13 +4,42 @@
  */
 
 #include "SerialPort.h"
+#include "ParserTramas.h"
 #include <cstdio>
 #include <cstring>
 
+/// Motivo del último fallo de abrirPuertoSerial
+static const char* errorSerial = "";
+
+const char* ultimoErrorSerial() {
+    return errorSerial;
+}
+
+/**
+ * @brief Indica si la velocidad aplicada está dentro de la tolerancia
+ * @details En 64 bits: long es de 32 bits en Windows y pedida * 1000 se
+ *          desbordaría por encima de ~2 Mbaudios
+ */
+static bool velocidadAceptable(long long pedida, long long aplicada) {
+    long long diferencia = pedida > aplicada ? pedida - aplicada : aplicada - pedida;
+    return diferencia * 1000 <= pedida * TOLERANCIA_BAUDIOS_MILESIMAS;
+}
+
 #ifdef _WIN32
 // ============ IMPLEMENTACIÓN WINDOWS ============
 
+bool velocidadSerialSoportada(int baudRate) {
+    // DCB admite cualquier valor; el controlador decide al abrir
+    return baudRate > 0;
+}
+
 SerialHandle abrirPuertoSerial(const char* portName, int baudRate) {
+    errorSerial = "";
+    if (baudRate <= 0) {
+        errorSerial = "velocidad inválida";
+        return INVALID_SERIAL_HANDLE;
+    }
+
     char fullPortName[20];
     snprintf(fullPortName, sizeof(fullPortName), "\\\\.\\%s", portName);
 
@@ -25,6 +54,7 @@ SerialHandle abrirPuertoSerial(const char* portName, int baudRate) {
     );
 
     if (hSerial == INVALID_HANDLE_VALUE) {
+        errorSerial = "no se pudo abrir el dispositivo";
         return INVALID_SERIAL_HANDLE;
     }
 
@@ -42,7 +72,9 @@ SerialHandle abrirPuertoSerial(const char* portName, int baudRate) {
     dcbSerialParams.StopBits = ONESTOPBIT;
     dcbSerialParams.Parity = NOPARITY;
 
-    if (!SetCommState(hSerial, &dcbSerialParams)) {
+    if (!SetCommState(hSerial, &dcbSerialParams) || !GetCommState(hSerial, &dcbSerialParams) ||
+        !velocidadAceptable(baudRate, (long long)dcbSerialParams.BaudRate)) {
+        errorSerial = "el controlador rechazó la velocidad";
         CloseHandle(hSerial);
         return INVALID_SERIAL_HANDLE;
     }
@@ -89,6 +121,81 @@ bool leerLineaSerial(SerialHandle handle, char* buffer, int bufferSize) {
     return pos > 0;
 }
 
+/**
+ * @brief Lee sin bloquear los bytes que ya estén en la cola del puerto
+ * @return Bytes leídos (0 si no había ninguno) o -1 si hubo error
+ */
+static int leerDisponibles(SerialHandle handle, char* destino, int maximo) {
+    DWORD errores;
+    COMSTAT estado;
+    if (!ClearCommError(handle, &errores, &estado)) {
+        return -1;
+    }
+
+    DWORD pedir = estado.cbInQue;
+    if (pedir == 0) return 0;
+    if (pedir > (DWORD)maximo) pedir = maximo;
+
+    DWORD bytesRead = 0;
+    if (!ReadFile(handle, destino, pedir, &bytesRead, NULL)) {
+        return -1;
+    }
+    return (int)bytesRead;
+}
+
+int esperarDatosSerial(SerialHandle handle, int timeoutMs) {
+    // Sin E/S superpuesta no hay espera por eventos: consultar la cola
+    DWORD inicio = GetTickCount();
+    for (;;) {
+        DWORD errores;
+        COMSTAT estado;
+        if (!ClearCommError(handle, &errores, &estado)) {
+            return -1;
+        }
+        if (estado.cbInQue > 0) {
+            return 1;
+        }
+        if (timeoutMs >= 0 && GetTickCount() - inicio >= (DWORD)timeoutMs) {
+            return 0;
+        }
+        Sleep(1);
+    }
+}
+
+int esperarDatosSeriales(const SerialHandle* handles, int n, bool* listos, bool* fallidos,
+                         int timeoutMs) {
+    if (n > MAX_PUERTOS_ESPERA) {
+        return -1;
+    }
+
+    DWORD inicio = GetTickCount();
+    for (;;) {
+        int cuenta = 0;
+        for (int i = 0; i < n; i++) {
+            listos[i] = false;
+            fallidos[i] = false;
+            if (handles[i] == INVALID_SERIAL_HANDLE) continue;
+
+            DWORD errores;
+            COMSTAT estado;
+            if (!ClearCommError(handles[i], &errores, &estado)) {
+                fallidos[i] = true;
+                cuenta++;
+            } else if (estado.cbInQue > 0) {
+                listos[i] = true;
+                cuenta++;
+            }
+        }
+        if (cuenta > 0) {
+            return cuenta;
+        }
+        if (timeoutMs >= 0 && GetTickCount() - inicio >= (DWORD)timeoutMs) {
+            return 0;
+        }
+        Sleep(1);
+    }
+}
+
 void cerrarPuertoSerial(SerialHandle handle) {
     if (handle != INVALID_SERIAL_HANDLE) {
         CloseHandle(handle);
@@ -117,27 +224,165 @@ void listarPuertosDisponibles() {
 #include <termios.h>
 #include <sys/ioctl.h>
 #include <dirent.h>
+#include <errno.h>
+#include <poll.h>
+
+// <asm/termbits.h> choca con <termios.h>: se replica struct termios2 en
+// las arquitecturas que usan la disposición genérica del kernel
+#if defined(__linux__) && defined(TCGETS2) && defined(TCSETS2) && \
+    (defined(__x86_64__) || defined(__i386__) || defined(__aarch64__) || \
+     defined(__arm__) || defined(__riscv))
+    #define PRT7_TERMIOS2 1
+
+/// Copia de struct termios2 (asm-generic/termbits.h)
+struct termios2 {
+    tcflag_t c_iflag;  ///< Modos de entrada
+    tcflag_t c_oflag;  ///< Modos de salida
+    tcflag_t c_cflag;  ///< Modos de control
+    tcflag_t c_lflag;  ///< Modos locales
+    cc_t c_line;       ///< Disciplina de línea
+    cc_t c_cc[19];     ///< Caracteres de control
+    speed_t c_ispeed;  ///< Velocidad de entrada en baudios
+    speed_t c_ospeed;  ///< Velocidad de salida en baudios
+};
+
+/// Bit de c_cflag que indica velocidad en c_ispeed/c_ospeed
+#define BOTHER_TERMIOS2 0010000
+#endif
+
+/**
+ * @struct VelocidadEstandar
+ * @brief Velocidad con constante B* propia
+ */
+struct VelocidadEstandar {
+    int baudios;       ///< Velocidad en baudios
+    speed_t constante; ///< Constante B* correspondiente
+};
+
+/// Velocidades estándar disponibles en esta plataforma
+static const VelocidadEstandar VELOCIDADES_ESTANDAR[] = {
+    { 1200, B1200 }, { 2400, B2400 }, { 4800, B4800 }, { 9600, B9600 },
+    { 19200, B19200 }, { 38400, B38400 }, { 57600, B57600 }, { 115200, B115200 },
+#ifdef B230400
+    { 230400, B230400 },
+#endif
+#ifdef B460800
+    { 460800, B460800 },
+#endif
+#ifdef B500000
+    { 500000, B500000 },
+#endif
+#ifdef B576000
+    { 576000, B576000 },
+#endif
+#ifdef B921600
+    { 921600, B921600 },
+#endif
+#ifdef B1000000
+    { 1000000, B1000000 },
+#endif
+#ifdef B1152000
+    { 1152000, B1152000 },
+#endif
+#ifdef B1500000
+    { 1500000, B1500000 },
+#endif
+#ifdef B2000000
+    { 2000000, B2000000 },
+#endif
+#ifdef B2500000
+    { 2500000, B2500000 },
+#endif
+#ifdef B3000000
+    { 3000000, B3000000 },
+#endif
+#ifdef B3500000
+    { 3500000, B3500000 },
+#endif
+#ifdef B4000000
+    { 4000000, B4000000 },
+#endif
+};
+
+/**
+ * @brief Busca la constante B* de una velocidad
+ * @return true si la velocidad es estándar en esta plataforma
+ */
+static bool buscarVelocidadEstandar(int baudRate, speed_t& constante) {
+    for (size_t i = 0; i < sizeof(VELOCIDADES_ESTANDAR) / sizeof(VELOCIDADES_ESTANDAR[0]); i++) {
+        if (VELOCIDADES_ESTANDAR[i].baudios == baudRate) {
+            constante = VELOCIDADES_ESTANDAR[i].constante;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool velocidadSerialSoportada(int baudRate) {
+    speed_t constante;
+    if (baudRate <= 0) return false;
+    if (buscarVelocidadEstandar(baudRate, constante)) return true;
+#ifdef PRT7_TERMIOS2
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Aplica una velocidad no estándar con termios2/BOTHER
+ * @return true si el controlador la aceptó dentro de la tolerancia
+ */
+static bool aplicarVelocidadArbitraria(int fd, int baudRate) {
+#ifdef PRT7_TERMIOS2
+    struct termios2 opciones;
+    if (ioctl(fd, TCGETS2, &opciones) != 0) return false;
+
+    opciones.c_cflag &= ~CBAUD;
+    opciones.c_cflag |= BOTHER_TERMIOS2;
+    opciones.c_ispeed = baudRate;
+    opciones.c_ospeed = baudRate;
+    if (ioctl(fd, TCSETS2, &opciones) != 0) return false;
+
+    // El controlador puede redondear a lo que permite su divisor de reloj
+    if (ioctl(fd, TCGETS2, &opciones) != 0) return false;
+    return velocidadAceptable(baudRate, (long long)opciones.c_ospeed);
+#else
+    (void)fd;
+    (void)baudRate;
+    return false;
+#endif
+}
 
 SerialHandle abrirPuertoSerial(const char* portName, int baudRate) {
+    errorSerial = "";
+    if (!velocidadSerialSoportada(baudRate)) {
+        errorSerial = baudRate <= 0 ? "velocidad inválida" : "velocidad no soportada en esta plataforma";
+        return INVALID_SERIAL_HANDLE;
+    }
+
     int fd = open(portName, O_RDWR | O_NOCTTY | O_NDELAY);
 
     if (fd == -1) {
+        errorSerial = "no se pudo abrir el dispositivo";
         return INVALID_SERIAL_HANDLE;
     }
 
     // Configurar puerto
     struct termios options;
-    tcgetattr(fd, &options);
-
-    // Configurar velocidad
-    speed_t speed = B9600;
-    if (baudRate == 115200) speed = B115200;
-    else if (baudRate == 57600) speed = B57600;
-    else if (baudRate == 38400) speed = B38400;
-    else if (baudRate == 19200) speed = B19200;
+    if (tcgetattr(fd, &options) != 0) {
+        errorSerial = "el dispositivo no es un puerto serial";
+        close(fd);
+        return INVALID_SERIAL_HANDLE;
+    }
 
-    cfsetispeed(&options, speed);
-    cfsetospeed(&options, speed);
+    // Configurar velocidad: las no estándar se aplican después con termios2
+    speed_t speed;
+    bool estandar = buscarVelocidadEstandar(baudRate, speed);
+    if (estandar) {
+        cfsetispeed(&options, speed);
+        cfsetospeed(&options, speed);
+    }
 
     // Configurar modo
     options.c_cflag |= (CLOCAL | CREAD);
@@ -155,7 +400,22 @@ SerialHandle abrirPuertoSerial(const char* portName, int baudRate) {
     options.c_cc[VMIN] = 0;
     options.c_cc[VTIME] = 5;
 
-    tcsetattr(fd, TCSANOW, &options);
+    bool aplicada;
+    if (estandar) {
+        // tcsetattr tiene éxito si aplica algún cambio: comprobar la velocidad
+        aplicada = tcsetattr(fd, TCSANOW, &options) == 0 &&
+                   tcgetattr(fd, &options) == 0 &&
+                   cfgetospeed(&options) == speed;
+    } else {
+        aplicada = tcsetattr(fd, TCSANOW, &options) == 0 &&
+                   aplicarVelocidadArbitraria(fd, baudRate);
+    }
+
+    if (!aplicada) {
+        errorSerial = "el controlador rechazó la velocidad";
+        close(fd);
+        return INVALID_SERIAL_HANDLE;
+    }
 
     return fd;
 }
@@ -189,6 +449,87 @@ bool leerLineaSerial(SerialHandle handle, char* buffer, int bufferSize) {
     return pos > 0;
 }
 
+/**
+ * @brief Lee sin bloquear los bytes que ya estén disponibles en el puerto
+ * @return Bytes leídos (0 si no había ninguno) o -1 si hubo error o el
+ *         otro extremo colgó
+ * @details El puerto se abre con O_NDELAY, así que sin datos read() falla
+ *          con EAGAIN; un 0 sólo puede ser fin de archivo (cuelgue)
+ */
+static int leerDisponibles(SerialHandle handle, char* destino, int maximo) {
+    int n = read(handle, destino, maximo);
+
+    if (n < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            return 0;
+        }
+        return -1;
+    }
+    if (n == 0 && maximo > 0) {
+        return -1;
+    }
+    return n;
+}
+
+int esperarDatosSerial(SerialHandle handle, int timeoutMs) {
+    struct pollfd pfd;
+    pfd.fd = handle;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    int r = poll(&pfd, 1, timeoutMs);
+    if (r < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+    if (r == 0) {
+        return 0;
+    }
+
+    // Con datos pendientes se leen aunque el otro extremo haya colgado;
+    // la lectura que encuentre el fin informará el fallo
+    if (pfd.revents & POLLIN) {
+        return 1;
+    }
+
+    // POLLHUP, POLLERR o POLLNVAL sin datos: el puerto ya no sirve
+    return -1;
+}
+
+int esperarDatosSeriales(const SerialHandle* handles, int n, bool* listos, bool* fallidos,
+                         int timeoutMs) {
+    if (n > MAX_PUERTOS_ESPERA) {
+        return -1;
+    }
+
+    struct pollfd pfds[MAX_PUERTOS_ESPERA];
+    for (int i = 0; i < n; i++) {
+        // poll() ignora los descriptores negativos
+        pfds[i].fd = handles[i];
+        pfds[i].events = POLLIN;
+        pfds[i].revents = 0;
+        listos[i] = false;
+        fallidos[i] = false;
+    }
+
+    int r = poll(pfds, n, timeoutMs);
+    if (r < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+
+    int cuenta = 0;
+    for (int i = 0; i < n; i++) {
+        if (pfds[i].revents & POLLIN) {
+            listos[i] = true;
+            cuenta++;
+        } else if (pfds[i].revents != 0) {
+            // Colgado o con error y sin datos pendientes
+            fallidos[i] = true;
+            cuenta++;
+        }
+    }
+    return cuenta;
+}
+
 void cerrarPuertoSerial(SerialHandle handle) {
     if (handle != INVALID_SERIAL_HANDLE) {
         close(handle);
@@ -210,4 +551,146 @@ void listarPuertosDisponibles() {
     }
 }
 
-#endif
\ No newline at end of file
+#endif
+
+// ============ LECTOR CON BÚFER (COMÚN) ============
+
+void inicializarLectorSerial(LectorSerial& lector, SerialHandle handle) {
+    lector.handle = handle;
+    lector.inicio = 0;
+    lector.fin = 0;
+    lector.bytesLeidos = 0;
+    lector.lecturas = 0;
+    lector.buffer[0] = '\0';
+}
+
+/**
+ * @brief Separa las líneas completas que ya están en el búfer
+ * @return Número de líneas agregadas a lineas
+ * @details Sustituye el '\n' (y un '\r' previo) por '\0' en el propio búfer
+ */
+static int extraerLineas(LectorSerial& lector, VistaLinea* lineas, int maxLineas) {
+    int total = 0;
+
+    while (total < maxLineas && lector.inicio < lector.fin) {
+        char* inicio = lector.buffer + lector.inicio;
+        char* salto = (char*)memchr(inicio, '\n', lector.fin - lector.inicio);
+        if (salto == nullptr) break;
+
+        char* finLinea = salto;
+        if (finLinea > inicio && finLinea[-1] == '\r') {
+            finLinea--;
+        }
+        *finLinea = '\0';
+
+        lector.inicio = (int)(salto - lector.buffer) + 1;
+
+        if (finLinea > inicio) {
+            lineas[total].datos = inicio;
+            lineas[total].longitud = (int)(finLinea - inicio);
+            total++;
+        }
+    }
+
+    return total;
+}
+
+/**
+ * @brief Separa las líneas completas del búfer y las clasifica como tramas
+ * @return Número de tramas agregadas a tramas
+ * @details Se detiene después de una TRAMA_FIN
+ */
+static int extraerTramas(LectorSerial& lector, TramaCompacta* tramas, int maxTramas) {
+    int total = 0;
+
+    while (total < maxTramas && lector.inicio < lector.fin) {
+        const char* inicio = lector.buffer + lector.inicio;
+        const char* salto = (const char*)memchr(inicio, '\n', lector.fin - lector.inicio);
+        if (salto == nullptr) break;
+
+        const char* finLinea = salto;
+        if (finLinea > inicio && finLinea[-1] == '\r') {
+            finLinea--;
+        }
+
+        lector.inicio = (int)(salto - lector.buffer) + 1;
+
+        if (finLinea > inicio && clasificarLinea(inicio, (int)(finLinea - inicio), tramas[total])) {
+            if (tramas[total++].tipo == TRAMA_FIN) break;
+        }
+    }
+
+    return total;
+}
+
+/**
+ * @brief Mueve la línea incompleta al principio del búfer y lee lo disponible
+ * @return Bytes leídos, -1 si el puerto falló o -2 si el búfer está lleno
+ *         con una sola línea (que el llamador debe entregar truncada)
+ */
+static int rellenarBuffer(LectorSerial& lector) {
+    // Mover la línea incompleta al principio para dejar espacio contiguo
+    if (lector.inicio > 0) {
+        memmove(lector.buffer, lector.buffer + lector.inicio, lector.fin - lector.inicio);
+        lector.fin -= lector.inicio;
+        lector.inicio = 0;
+    }
+
+    int libres = TAM_BUFFER_LECTOR - 1 - lector.fin;
+    if (libres == 0) {
+        return -2;
+    }
+
+    int n = leerDisponibles(lector.handle, lector.buffer + lector.fin, libres);
+    if (n < 0) return -1;
+    lector.fin += n;
+    if (n > 0) {
+        lector.bytesLeidos += n;
+        lector.lecturas++;
+    }
+    return n;
+}
+
+int leerLineas(LectorSerial& lector, VistaLinea* lineas, int maxLineas) {
+    if (lector.handle == INVALID_SERIAL_HANDLE || lineas == nullptr || maxLineas <= 0) {
+        return -1;
+    }
+
+    int total = extraerLineas(lector, lineas, maxLineas);
+    if (total > 0) return total;
+
+    int n = rellenarBuffer(lector);
+    if (n == -2) {
+        // Línea más larga que el búfer: entregarla truncada
+        lector.buffer[lector.fin] = '\0';
+        lineas[0].datos = lector.buffer;
+        lineas[0].longitud = lector.fin;
+        lector.inicio = 0;
+        lector.fin = 0;
+        return 1;
+    }
+    if (n < 0) return -1;
+
+    return extraerLineas(lector, lineas, maxLineas);
+}
+
+int leerTramas(LectorSerial& lector, TramaCompacta* tramas, int maxTramas) {
+    if (lector.handle == INVALID_SERIAL_HANDLE || tramas == nullptr || maxTramas <= 0) {
+        return -1;
+    }
+
+    int total = extraerTramas(lector, tramas, maxTramas);
+    if (total > 0) return total;
+
+    int n = rellenarBuffer(lector);
+    if (n == -2) {
+        // Línea más larga que el búfer: analizarla truncada
+        int longitud = lector.fin;
+        lector.inicio = 0;
+        lector.fin = 0;
+        return clasificarLinea(lector.buffer, longitud, tramas[0]) ? 1 : 0;
+    }
+    if (n < 0) return -1;
+
+    return extraerTramas(lector, tramas, maxTramas);
+}
@@ -8,6 +8,8 @@
 #ifndef SERIAL_PORT_H
 #define SERIAL_PORT_H
 
+#include "TramaCompacta.h"
+
 #ifdef _WIN32
     #include <windows.h>
     typedef HANDLE SerialHandle;
@@ -17,14 +19,39 @@ typedef int SerialHandle;
 #define INVALID_SERIAL_HANDLE -1
 #endif
 
+/// Velocidad por defecto (la del transmisor Arduino)
+#define BAUDIOS_DEFECTO 9600
+
+/// Diferencia máxima, en milésimas, entre la velocidad pedida y la que
+/// aplica el controlador para una velocidad no estándar
+#define TOLERANCIA_BAUDIOS_MILESIMAS 20
+
 /**
  * @brief Abre un puerto serial
  * @param portName Nombre del puerto (ej: "COM3" en Windows, "/dev/ttyUSB0" en Linux)
- * @param baudRate Velocidad en baudios (ej: 9600)
+ * @param baudRate Velocidad en baudios (ej: 9600, 921600 o una no estándar)
  * @return Handle del puerto o INVALID_SERIAL_HANDLE si falla
+ * @details En Linux las velocidades estándar (hasta 4000000) usan las
+ *          constantes B*; cualquier otra se pide con termios2/BOTHER. Si
+ *          el controlador no acepta la velocidad el puerto no se abre (ver
+ *          ultimoErrorSerial); nunca se usa otra velocidad en silencio.
  */
 SerialHandle abrirPuertoSerial(const char* portName, int baudRate);
 
+/**
+ * @brief Indica si la plataforma puede pedir una velocidad
+ * @param baudRate Velocidad en baudios
+ * @return true si es estándar o si se admiten velocidades arbitrarias
+ * @details El controlador del puerto todavía puede rechazarla al abrir
+ */
+bool velocidadSerialSoportada(int baudRate);
+
+/**
+ * @brief Describe por qué falló el último abrirPuertoSerial
+ * @return Mensaje estático (cadena vacía si no hubo error)
+ */
+const char* ultimoErrorSerial();
+
 /**
  * @brief Lee una línea desde el puerto serial
  * @param handle Handle del puerto
@@ -35,6 +62,104 @@ SerialHandle abrirPuertoSerial(const char* portName, int baudRate);
  */
 bool leerLineaSerial(SerialHandle handle, char* buffer, int bufferSize);
 
+/// Capacidad del búfer de un LectorSerial (incluye el terminador)
+#define TAM_BUFFER_LECTOR 4096
+
+/**
+ * @struct VistaLinea
+ * @brief Línea recibida, vista directamente dentro del búfer del lector
+ * @details No es una copia: deja de ser válida en la siguiente llamada a
+ *          leerLineas. datos termina en '\0' y no incluye "\r\n".
+ */
+struct VistaLinea {
+    const char* datos; ///< Primer carácter de la línea
+    int longitud;      ///< Número de caracteres (sin el terminador)
+};
+
+/**
+ * @struct LectorSerial
+ * @brief Lector con búfer que separa líneas de un puerto serial
+ * @details Cada lectura trae todos los bytes disponibles de una vez en lugar
+ *          de uno por llamada. Los bytes de una línea incompleta se
+ *          conservan para la siguiente lectura.
+ */
+struct LectorSerial {
+    SerialHandle handle;             ///< Puerto del que se lee
+    char buffer[TAM_BUFFER_LECTOR];  ///< Bytes recibidos
+    int inicio;                      ///< Primer byte aún no entregado
+    int fin;                         ///< Fin de los bytes recibidos
+    unsigned long long bytesLeidos;  ///< Bytes recibidos desde la inicialización
+    unsigned long long lecturas;     ///< Lecturas del puerto que trajeron datos
+};
+
+/**
+ * @brief Prepara un lector para un puerto ya abierto
+ * @param lector Lector a inicializar
+ * @param handle Handle del puerto
+ */
+void inicializarLectorSerial(LectorSerial& lector, SerialHandle handle);
+
+/**
+ * @brief Lee todas las líneas completas disponibles
+ * @param lector Lector del puerto
+ * @param lineas Arreglo donde se devuelven las vistas de las líneas
+ * @param maxLineas Capacidad del arreglo
+ * @return Número de líneas devueltas (0 si no hay ninguna completa),
+ *         o -1 si el puerto falló
+ * @details Entrega primero las líneas que ya estén en el búfer y sólo si
+ *          no hay ninguna hace una lectura no bloqueante del puerto.
+ *          Las líneas vacías se descartan. Una línea más larga que el búfer
+ *          se entrega truncada.
+ */
+int leerLineas(LectorSerial& lector, VistaLinea* lineas, int maxLineas);
+
+/**
+ * @brief Lee todas las tramas completas disponibles, ya analizadas
+ * @param lector Lector del puerto
+ * @param tramas Arreglo del llamador donde se devuelven las tramas; se
+ *               reutiliza de una llamada a otra
+ * @param maxTramas Capacidad del arreglo
+ * @return Número de tramas devueltas (0 si no hay ninguna línea completa),
+ *         o -1 si el puerto falló
+ * @details Igual que leerLineas, pero cada línea se clasifica dentro del
+ *          propio búfer (clasificarLinea) y se entrega como trama compacta:
+ *          un lote por despertar, sin vistas intermedias ni memoria
+ *          dinámica. Las marcas llegan como TRAMA_INICIO/TRAMA_FIN y las
+ *          líneas rechazadas como TRAMA_INVALIDA. El lote termina en la
+ *          primera TRAMA_FIN; lo que sigue queda en el búfer.
+ */
+int leerTramas(LectorSerial& lector, TramaCompacta* tramas, int maxTramas);
+
+/**
+ * @brief Espera a que el puerto tenga datos para leer
+ * @param handle Handle del puerto
+ * @param timeoutMs Tiempo máximo de espera en milisegundos (-1 = sin límite)
+ * @return 1 si hay datos, 0 si se agotó el tiempo, -1 si hubo error o el
+ *         otro extremo colgó sin dejar datos pendientes
+ * @details En Linux bloquea en poll() sobre el descriptor del puerto
+ */
+int esperarDatosSerial(SerialHandle handle, int timeoutMs);
+
+/// Máximo de puertos que admite esperarDatosSeriales en una llamada
+#define MAX_PUERTOS_ESPERA 64
+
+/**
+ * @brief Espera a que alguno de varios puertos tenga datos para leer
+ * @param handles Puertos a vigilar (INVALID_SERIAL_HANDLE se ignora)
+ * @param n Número de puertos (como máximo MAX_PUERTOS_ESPERA)
+ * @param listos Salida: listos[i] = true si handles[i] tiene datos
+ * @param fallidos Salida: fallidos[i] = true si handles[i] colgó o falló
+ *                 sin dejar datos pendientes
+ * @param timeoutMs Tiempo máximo de espera en milisegundos (-1 = sin límite)
+ * @return Número de puertos listos o fallidos, 0 si se agotó el tiempo,
+ *         -1 si hubo error
+ * @details En Linux es un único poll() sobre todos los descriptores. Un
+ *          puerto que colgó con datos pendientes se marca listo: la
+ *          lectura que llegue al final informará el fallo.
+ */
+int esperarDatosSeriales(const SerialHandle* handles, int n, bool* listos, bool* fallidos,
+                         int timeoutMs);
+
 /**
  * @brief Cierra el puerto serial
  * @param handle Handle del puerto a cerrar
@@ -36,9 +36,13 @@ public:
 
     /**
      * @brief Obtiene una representación en texto de la trama
-     * @return Cadena con el contenido de la trama
+     * @param destino Buffer donde se escribe la cadena
+     * @param tamano Tamaño del buffer
+     * @return destino, con el contenido de la trama
+     * @details El texto se genera sólo cuando se pide, así las tramas
+     *          no necesitan guardar un buffer propio
      */
-    virtual const char* toString() const = 0;
+    virtual const char* toString(char* destino, int tamano) const = 0;
 };
 
 #endif // TRAMA_BASE_H
\ No newline at end of file
@@ -0,0 +1,70 @@
+/**
+ * @file TramaCompacta.h
+ * @brief Representación por valor de una trama PRT-7
+ * @details Alternativa sin herencia ni memoria dinámica a TramaLoad/TramaMap,
+ *          pensada para decodificar arreglos grandes de tramas
+ */
+
+#ifndef TRAMA_COMPACTA_H
+#define TRAMA_COMPACTA_H
+
+/**
+ * @enum TipoTrama
+ * @brief Tipo de una trama compacta (coincide con la letra del protocolo)
+ */
+enum TipoTrama {
+    TRAMA_LOAD = 'L',     ///< Trama de carga "L,X"
+    TRAMA_MAP = 'M',      ///< Trama de mapeo "M,N"
+    TRAMA_INICIO = 'I',   ///< Marca de control INICIO_TRANSMISION_PRT7
+    TRAMA_FIN = 'F',      ///< Marca de control FIN_TRANSMISION_PRT7
+    TRAMA_INVALIDA = 'X'  ///< Línea rechazada (valor = código ErrorTrama)
+};
+
+/**
+ * @struct TramaCompacta
+ * @brief Trama PRT-7 almacenada por valor (8 bytes)
+ */
+struct TramaCompacta {
+    int valor;          ///< Carácter (LOAD) o rotación (MAP)
+    unsigned char tipo; ///< TRAMA_LOAD, TRAMA_MAP o una marca de control
+};
+
+/**
+ * @brief Construye una trama LOAD compacta
+ * @param c Carácter de la trama
+ * @return Trama compacta
+ */
+inline TramaCompacta crearTramaLoad(char c) {
+    TramaCompacta t;
+    t.valor = (unsigned char)c;
+    t.tipo = TRAMA_LOAD;
+    return t;
+}
+
+/**
+ * @brief Construye una trama MAP compacta
+ * @param n Valor de rotación
+ * @return Trama compacta
+ */
+inline TramaCompacta crearTramaMap(int n) {
+    TramaCompacta t;
+    t.valor = n;
+    t.tipo = TRAMA_MAP;
+    return t;
+}
+
+/**
+ * @brief Construye una marca de control (inicio, fin o línea inválida)
+ * @param tipo TRAMA_INICIO, TRAMA_FIN o TRAMA_INVALIDA
+ * @param valor Dato asociado (código de error en TRAMA_INVALIDA)
+ * @return Trama compacta
+ * @details Los decodificadores por lote ignoran estas marcas
+ */
+inline TramaCompacta crearTramaControl(TipoTrama tipo, int valor = 0) {
+    TramaCompacta t;
+    t.valor = valor;
+    t.tipo = (unsigned char)tipo;
+    return t;
+}
+
+#endif // TRAMA_COMPACTA_H
@@ -9,7 +9,6 @@
 #include <cstdio>
 
 TramaLoad::TramaLoad(char c) : caracter(c) {
-    buffer[0] = '\0';
 }
 
 TramaLoad::~TramaLoad() {
@@ -24,9 +23,7 @@ void TramaLoad::procesar(ListaDeCarga* carga, RotorDeMapeo* rotor) {
     carga->insertarAlFinal(decodificado);
 }
 
-const char* TramaLoad::toString() const {
-    // Usar un buffer mutable para construir la cadena
-    char* buf = const_cast<char*>(buffer);
-    snprintf(buf, 20, "L,%c", caracter);
-    return buffer;
-}
\ No newline at end of file
+const char* TramaLoad::toString(char* destino, int tamano) const {
+    snprintf(destino, tamano, "L,%c", caracter);
+    return destino;
+}
@@ -16,7 +16,6 @@
 class TramaLoad : public TramaBase {
 private:
     char caracter; ///< Carácter a decodificar
-    char buffer[20]; ///< Buffer para toString()
 
 public:
     /**
@@ -40,9 +39,11 @@ public:
 
     /**
      * @brief Obtiene representación de la trama
+     * @param destino Buffer donde se escribe la cadena
+     * @param tamano Tamaño del buffer
      * @return Cadena con formato "L,X"
      */
-    const char* toString() const override;
+    const char* toString(char* destino, int tamano) const override;
 
     /**
      * @brief Obtiene el carácter almacenado
@@ -9,7 +9,6 @@
 #include <cstdio>
 
 TramaMap::TramaMap(int n) : rotacion(n) {
-    buffer[0] = '\0';
 }
 
 TramaMap::~TramaMap() {
@@ -21,9 +20,7 @@ void TramaMap::procesar(ListaDeCarga* carga, RotorDeMapeo* rotor) {
     rotor->rotar(rotacion);
 }
 
-const char* TramaMap::toString() const {
-    // Usar un buffer mutable para construir la cadena
-    char* buf = const_cast<char*>(buffer);
-    snprintf(buf, 20, "M,%d", rotacion);
-    return buffer;
-}
\ No newline at end of file
+const char* TramaMap::toString(char* destino, int tamano) const {
+    snprintf(destino, tamano, "M,%d", rotacion);
+    return destino;
+}
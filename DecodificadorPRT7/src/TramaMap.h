@@ -16,7 +16,6 @@
 class TramaMap : public TramaBase {
 private:
     int rotacion; ///< Cantidad de posiciones a rotar (+ o -)
-    char buffer[20]; ///< Buffer para toString()
 
 public:
     /**
@@ -40,9 +39,11 @@ public:
 
     /**
      * @brief Obtiene representación de la trama
+     * @param destino Buffer donde se escribe la cadena
+     * @param tamano Tamaño del buffer
      * @return Cadena con formato "M,N"
      */
-    const char* toString() const override;
+    const char* toString(char* destino, int tamano) const override;
 
     /**
      * @brief Obtiene el valor de rotación
@@ -2,15 +2,17 @@
  * @file main.cpp
  * @brief Programa principal del Decodificador PRT-7
  * @details Sistema que decodifica mensajes del protocolo industrial PRT-7
- *          recibidos desde un Arduino vía puerto serial
+ *          recibidos desde un Arduino vía puerto serial, o reproducidos
+ *          desde una captura grabada en archivo o stdin
  * @author Equipo de Desarrollo
  * @date 2025
  */
 
+#include <climits>
 #include <cstdio>
 #include <cstring>
-#include <cctype>
 #include <cstdlib>
+#include <thread>
 
 #include "SerialPort.h"
 #include "TramaBase.h"
@@ -18,6 +20,16 @@
 #include "TramaMap.h"
 #include "ListaDeCarga.h"
 #include "RotorDeMapeo.h"
+#include "DecodificadorLote.h"
+#include "ParserTramas.h"
+#include "ArenaTramas.h"
+#include "CapturaArchivo.h"
+#include "FormatoBinario.h"
+#include "ColaTramas.h"
+#include "EscritorSalida.h"
+#include "MetricasPRT7.h"
+#include "PuntoControl.h"
+#include "Argumentos.h"
 
 #ifdef _WIN32
     #include <windows.h>
@@ -27,57 +39,771 @@
     #define SLEEP_MS(ms) usleep((ms) * 1000)
 #endif
 
+/// Máximo de tramas que se analizan por cada lectura del puerto
+/// (un búfer de lector lleno de líneas "L,X" tiene TAM_BUFFER_LECTOR / 4)
+#define MAX_TRAMAS_LOTE (TAM_BUFFER_LECTOR / 4)
+
+/// Espera máxima por defecto sin datos antes de volver a revisar el puerto
+#define INACTIVIDAD_MS_DEFECTO 1000
+
+/// Capacidad de la cola entre el hilo lector y el decodificador
+#define CAPACIDAD_COLA_TRAMAS 4096
+
+/// Máximo de tramas que el decodificador toma de la cola por vuelta
+#define MAX_TRAMAS_CONSUMO 1024
+
+/// Espera máxima del decodificador con la cola vacía (acota la respuesta a
+/// SIGUSR1 y a la línea de estadísticas)
+#define ESPERA_COLA_MS 100
+
+/// Se cronometra una de cada MUESTREO_LATENCIA líneas en el camino sin lotes
+#define MUESTREO_LATENCIA 64
+
+/// Tramas entre dos instantáneas del punto de control por defecto
+#define INTERVALO_CONTROL_DEFECTO 4096
+
+/// Máximo de puertos que se decodifican a la vez
+#define MAX_PUERTOS MAX_PUERTOS_ESPERA
+
+/// Bytes de la captura que se procesan por vuelta junto a los puertos
+/// (caben en un lote de MAX_TRAMAS_LOTE tramas)
+#define TAM_TRAMO_MULTIFLUJO (2 * MAX_TRAMAS_LOTE - 1)
+
+/// Bytes de captura de texto que se analizan y decodifican por ventana
+#define TAM_VENTANA_CAPTURA (1 << 22)
+
+/// Máximo de hilos que se aceptan con --hilos
+#define MAX_HILOS 256
+
+/**
+ * @enum NivelLog
+ * @brief Cantidad de información que se muestra durante la decodificación
+ */
+enum NivelLog {
+    LOG_SILENCIOSO = 0, ///< Sólo el resumen final
+    LOG_NORMAL,         ///< Marcas de control y el mensaje a medida que llega
+    LOG_DETALLADO       ///< Además, el eco de cada trama
+};
+
+/**
+ * @struct Configuracion
+ * @brief Opciones de ejecución leídas de la línea de comandos
+ */
+struct Configuracion {
+    int inactividadMs;     ///< Espera máxima de poll() sin datos, en ms
+    int baudios;           ///< Velocidad de los puertos seriales
+    NivelLog nivel;        ///< Nivel de detalle de la salida
+    FormatoSalida formato; ///< Formato del mensaje en el resumen final
+    const char* registro;  ///< Archivo del registro NDJSON de tramas (nullptr = sin registro)
+    const char* metricas;  ///< Archivo de métricas (.json o texto Prometheus; nullptr = ninguno)
+    int estadisticasSeg;   ///< Intervalo de la línea de estadísticas (0 = desactivada)
+    const char* puntoControl; ///< Archivo de instantáneas (nullptr = sin punto de control)
+    int intervaloControl;  ///< Tramas entre dos instantáneas
+    bool reanudar;         ///< Continuar desde la última instantánea de puntoControl
+    const char* cableado;  ///< Permutación del alfabeto del rotor (nullptr = identidad)
+    long long ventanaDesde;    ///< Primer carácter de la ventana a mostrar (-1 = ninguna)
+    long long ventanaCantidad; ///< Caracteres de la ventana
+    int hilos;             ///< Hilos para reproducir capturas (0 = núcleos)
+    bool ayuda;            ///< Sólo mostrar la ayuda y salir
+    const char* puertos[MAX_PUERTOS]; ///< Puertos seriales (ninguno = preguntar al usuario)
+    int numPuertos;        ///< Número de puertos indicados con --puerto
+    const char* captura;   ///< Captura a reproducir ("-" = stdin, nullptr = modo serial)
+};
+
+/**
+ * @brief Imprime las opciones de línea de comandos
+ * @param programa Nombre del ejecutable
+ */
+void imprimirUso(const char* programa) {
+    printf("Uso: %s [opciones]\n", programa);
+    printf("  --puerto NOMBRE    Puerto serial a usar (si falta, se pregunta); puede\n");
+    printf("                     repetirse para decodificar varios puertos a la vez\n");
+    printf("  --archivo RUTA     Reproduce una captura grabada; \"-\" lee de stdin. Con\n");
+    printf("                     --puerto se decodifica como un flujo más junto a los\n");
+    printf("                     puertos (stdin se lee completo antes de empezar)\n");
+    printf("  --baudios N        Velocidad del puerto (defecto %d; admite 230400-4000000\n",
+           BAUDIOS_DEFECTO);
+    printf("                     y, en Linux, velocidades no estándar)\n");
+    printf("  --inactividad MS   Espera máxima sin datos antes de revisar el puerto (defecto %d)\n",
+           INACTIVIDAD_MS_DEFECTO);
+    printf("  --nivel NIVEL      silencioso, normal (defecto) o detallado (eco de cada trama)\n");
+    printf("  --formato FORMATO  Mensaje final: cruda (defecto), corchetes o ndjson\n");
+    printf("  --registro RUTA    Escribe un registro NDJSON con una línea por trama\n");
+    printf("  --metricas RUTA    Guarda métricas al salir y con SIGUSR1 (.json o Prometheus)\n");
+    printf("  --estadisticas SEG Imprime una línea de estadísticas en stderr cada SEG segundos\n");
+    printf("  --punto-control RUTA  Guarda instantáneas del estado para poder reanudar\n");
+    printf("  --intervalo-control N Tramas entre instantáneas (defecto %d)\n",
+           INTERVALO_CONTROL_DEFECTO);
+    printf("  --reanudar         Continúa desde la última instantánea de --punto-control\n");
+    printf("  --cableado PERM    Cableado del rotor: las %d letras del alfabeto permutadas\n",
+           (int)sizeof(ALFABETO_PRT7) - 1);
+    printf("  --ventana DESDE:N  Muestra además los N caracteres del mensaje desde DESDE\n");
+    printf("  --hilos H          Hilos para reproducir capturas (defecto: núcleos; 1 = secuencial)\n");
+    printf("  --ayuda            Muestra esta ayuda\n");
+}
+
 /**
- * @brief Parsea una línea del protocolo PRT-7
- * @param linea Cadena recibida del puerto serial
- * @return Puntero a TramaBase (TramaLoad o TramaMap) o nullptr si es inválida
- * @details Formato esperado: "L,X" o "M,N"
+ * @brief Lee las opciones de la línea de comandos
+ * @param argc Número de argumentos
+ * @param argv Argumentos
+ * @param config Configuración a completar
+ * @return true si las opciones son válidas
  */
-TramaBase* parsearTrama(const char* linea) {
-    if (linea == nullptr || linea[0] == '\0') {
-        return nullptr;
+bool leerArgumentos(int argc, char* argv[], Configuracion& config) {
+    config.inactividadMs = INACTIVIDAD_MS_DEFECTO;
+    config.baudios = BAUDIOS_DEFECTO;
+    config.nivel = LOG_NORMAL;
+    config.formato = SALIDA_CRUDA;
+    config.registro = nullptr;
+    config.metricas = nullptr;
+    config.estadisticasSeg = 0;
+    config.puntoControl = nullptr;
+    config.intervaloControl = INTERVALO_CONTROL_DEFECTO;
+    config.reanudar = false;
+    config.cableado = nullptr;
+    config.ventanaDesde = -1;
+    config.ventanaCantidad = 0;
+    config.hilos = 0;
+    config.ayuda = false;
+    config.numPuertos = 0;
+    config.captura = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--puerto") == 0 && i + 1 < argc) {
+            if (config.numPuertos == MAX_PUERTOS) {
+                printf("ERROR: Se admiten como máximo %d puertos\n", MAX_PUERTOS);
+                return false;
+            }
+            config.puertos[config.numPuertos++] = argv[++i];
+        } else if (strcmp(argv[i], "--archivo") == 0 && i + 1 < argc) {
+            config.captura = argv[++i];
+        } else if (strcmp(argv[i], "--baudios") == 0 && i + 1 < argc) {
+            if (!leerEntero(argv[++i], 1, INT_MAX, config.baudios) ||
+                !velocidadSerialSoportada(config.baudios)) {
+                printf("ERROR: --baudios %s no es una velocidad soportada en esta plataforma\n", argv[i]);
+                return false;
+            }
+        } else if (strcmp(argv[i], "--inactividad") == 0 && i + 1 < argc) {
+            if (!leerEntero(argv[++i], 1, INT_MAX, config.inactividadMs)) {
+                printf("ERROR: --inactividad debe ser un número de milisegundos mayor que 0\n");
+                return false;
+            }
+        } else if (strcmp(argv[i], "--nivel") == 0 && i + 1 < argc) {
+            const char* nivel = argv[++i];
+            if (strcmp(nivel, "silencioso") == 0) {
+                config.nivel = LOG_SILENCIOSO;
+            } else if (strcmp(nivel, "normal") == 0) {
+                config.nivel = LOG_NORMAL;
+            } else if (strcmp(nivel, "detallado") == 0) {
+                config.nivel = LOG_DETALLADO;
+            } else {
+                printf("ERROR: Nivel desconocido: %s\n", nivel);
+                return false;
+            }
+        } else if (strcmp(argv[i], "--formato") == 0 && i + 1 < argc) {
+            const char* formato = argv[++i];
+            if (strcmp(formato, "cruda") == 0) {
+                config.formato = SALIDA_CRUDA;
+            } else if (strcmp(formato, "corchetes") == 0) {
+                config.formato = SALIDA_CORCHETES;
+            } else if (strcmp(formato, "ndjson") == 0) {
+                config.formato = SALIDA_NDJSON;
+            } else {
+                printf("ERROR: Formato desconocido: %s\n", formato);
+                return false;
+            }
+        } else if (strcmp(argv[i], "--registro") == 0 && i + 1 < argc) {
+            config.registro = argv[++i];
+        } else if (strcmp(argv[i], "--metricas") == 0 && i + 1 < argc) {
+            config.metricas = argv[++i];
+        } else if (strcmp(argv[i], "--estadisticas") == 0 && i + 1 < argc) {
+            if (!leerEntero(argv[++i], 0, INT_MAX, config.estadisticasSeg)) {
+                printf("ERROR: --estadisticas debe ser un número de segundos (0 = desactivada)\n");
+                return false;
+            }
+        } else if (strcmp(argv[i], "--punto-control") == 0 && i + 1 < argc) {
+            config.puntoControl = argv[++i];
+        } else if (strcmp(argv[i], "--intervalo-control") == 0 && i + 1 < argc) {
+            if (!leerEntero(argv[++i], 1, INT_MAX, config.intervaloControl)) {
+                printf("ERROR: --intervalo-control debe ser un número de tramas mayor que 0\n");
+                return false;
+            }
+        } else if (strcmp(argv[i], "--reanudar") == 0) {
+            config.reanudar = true;
+        } else if (strcmp(argv[i], "--cableado") == 0 && i + 1 < argc) {
+            config.cableado = argv[++i];
+            RotorDeMapeo prueba;
+            if (!prueba.setCableado(config.cableado)) {
+                printf("ERROR: --cableado debe ser una permutación de \"%s\"\n", ALFABETO_PRT7);
+                return false;
+            }
+        } else if (strcmp(argv[i], "--ventana") == 0 && i + 1 < argc) {
+            const char* ventana = argv[++i];
+            int leidos = 0;
+            if (sscanf(ventana, "%lld:%lld%n", &config.ventanaDesde, &config.ventanaCantidad,
+                       &leidos) != 2 || ventana[leidos] != '\0' ||
+                config.ventanaDesde < 0 || config.ventanaCantidad <= 0) {
+                printf("ERROR: --ventana espera DESDE:N con DESDE >= 0 y N > 0\n");
+                return false;
+            }
+        } else if (strcmp(argv[i], "--hilos") == 0 && i + 1 < argc) {
+            if (!leerEntero(argv[++i], 1, MAX_HILOS, config.hilos)) {
+                printf("ERROR: --hilos debe estar entre 1 y %d\n", MAX_HILOS);
+                return false;
+            }
+        } else if (strcmp(argv[i], "--ayuda") == 0) {
+            config.ayuda = true;
+        } else {
+            return false;
+        }
     }
 
-    // Copiar la línea para no modificar el original
-    char buffer[100];
-    strncpy(buffer, linea, 99);
-    buffer[99] = '\0';
+    if (config.puntoControl != nullptr &&
+        config.numPuertos + (config.captura != nullptr ? 1 : 0) > 1) {
+        printf("ERROR: --punto-control admite un solo flujo\n");
+        return false;
+    }
 
-    // Eliminar espacios en blanco al inicio y final
-    char* inicio = buffer;
-    while (*inicio == ' ' || *inicio == '\t' || *inicio == '\r' || *inicio == '\n') {
-        inicio++;
+    if (config.reanudar && config.puntoControl == nullptr) {
+        printf("ERROR: --reanudar requiere --punto-control\n");
+        return false;
     }
 
-    int len = strlen(inicio);
-    while (len > 0 && (inicio[len-1] == ' ' || inicio[len-1] == '\t' ||
-           inicio[len-1] == '\r' || inicio[len-1] == '\n')) {
-        inicio[--len] = '\0';
+    return true;
+}
+
+/**
+ * @struct Instrumentacion
+ * @brief Salidas auxiliares compartidas por todos los flujos
+ */
+struct Instrumentacion {
+    EscritorSalida* registro;       ///< Registro NDJSON de tramas (nullptr = sin registro)
+    MetricasPRT7 metricas;          ///< Contadores e histogramas de la ejecución
+    const char* rutaMetricas;       ///< Archivo de métricas (nullptr = ninguno)
+    unsigned long long intervaloNs; ///< Período de la línea de estadísticas (0 = ninguna)
+    unsigned long long proximaNs;   ///< Reloj de la próxima línea de estadísticas
+
+    Instrumentacion()
+        : registro(nullptr), rutaMetricas(nullptr), intervaloNs(0), proximaNs(0) {}
+};
+
+/**
+ * @brief Atiende la línea periódica de estadísticas y las solicitudes SIGUSR1
+ * @param inst Instrumentación de la ejecución
+ * @details Se llama desde el hilo decodificador en cada vuelta del bucle
+ */
+void revisarMetricas(Instrumentacion& inst) {
+    if (inst.intervaloNs > 0) {
+        unsigned long long ahora = relojNs();
+        if (ahora >= inst.proximaNs) {
+            imprimirLineaEstadisticas(inst.metricas, stderr);
+            inst.proximaNs = ahora + inst.intervaloNs;
+        }
+    }
+
+    if (consumirSenalMetricas()) {
+        if (inst.rutaMetricas == nullptr) {
+            imprimirLineaEstadisticas(inst.metricas, stderr);
+        } else if (!guardarMetricas(inst.metricas, inst.rutaMetricas)) {
+            fprintf(stderr, "ERROR: No se pudieron guardar las métricas en %s\n",
+                    inst.rutaMetricas);
+        }
+    }
+}
+
+/**
+ * @struct SesionPRT7
+ * @brief Estado de decodificación independiente de un flujo (puerto o captura)
+ */
+struct SesionPRT7 {
+    const char* nombre;          ///< Puerto o captura del flujo
+    SerialHandle puerto;         ///< Puerto abierto (INVALID_SERIAL_HANDLE si no aplica)
+    LectorSerial lector;         ///< Lector con búfer del puerto
+    ListaDeCarga listaCarga;     ///< Mensaje ensamblado
+    RotorDeMapeo rotor;          ///< Rotor de mapeo del flujo
+    ArenaTramas arena;           ///< Arena para las tramas del flujo
+    long long tramasRecibidas;   ///< Tramas válidas procesadas
+    long long tramasInvalidas;   ///< Líneas rechazadas por el parser
+    bool terminada;              ///< Se recibió el fin de transmisión o falló el puerto
+    EscritorSalida salida;       ///< Búfer hacia stdout para el mensaje
+    EscritorSalida* registro;    ///< Registro NDJSON de tramas (compartido, puede ser nullptr)
+    long long secuencia;         ///< Número de la siguiente entrada del registro
+    MetricasPRT7* metricas;      ///< Métricas compartidas (nunca nullptr una vez iniciada)
+    PuntoControl* control;       ///< Instantáneas de la sesión (nullptr = desactivadas)
+    long long intervaloControl;  ///< Tramas entre dos instantáneas
+    long long proximoControl;    ///< Tramas tras las que toca la siguiente instantánea
+    int hilos;                   ///< Hilos para decodificar lotes grandes (1 = secuencial)
+
+    SesionPRT7()
+        : nombre(nullptr), puerto(INVALID_SERIAL_HANDLE), tramasRecibidas(0),
+          tramasInvalidas(0), terminada(false), salida(stdout, TAM_BUFFER_CONSOLA), registro(nullptr),
+          secuencia(0), metricas(nullptr), control(nullptr), intervaloControl(0),
+          proximoControl(0), hilos(1) {}
+
+    /**
+     * @brief Destructor: cierra (y sincroniza) el punto de control
+     */
+    ~SesionPRT7() { delete control; }
+
+    /**
+     * @brief Conecta la sesión a la instrumentación de la ejecución
+     * @param inst Registro y métricas compartidos
+     */
+    void instrumentar(Instrumentacion& inst) {
+        registro = inst.registro;
+        metricas = &inst.metricas;
     }
 
-    // Verificar formato mínimo
-    if (len < 3) {
-        return nullptr;
+    /**
+     * @brief Aplica el cableado pedido al rotor (ya validado en leerArgumentos)
+     * @param config Configuración de ejecución
+     */
+    void cablearRotor(const Configuracion& config) {
+        if (config.cableado != nullptr) {
+            rotor.setCableado(config.cableado);
+        }
     }
+};
 
-    char tipo = toupper(inicio[0]);
+/**
+ * @brief Activa el punto de control de una sesión y, si se pide, la reanuda
+ * @param sesion Sesión recién creada
+ * @param config Configuración de ejecución
+ * @return false si no se pudo abrir el archivo de control o si sus
+ *         instantáneas son de otro rotor
+ * @details Al reanudar se recuperan el mensaje, el rotor y los contadores
+ *          de la última instantánea válida, y se descarta del archivo
+ *          cualquier registro cortado posterior. Sin --reanudar el archivo
+ *          se vacía. El rotor ya debe estar cableado.
+ */
+bool prepararPuntoControl(SesionPRT7& sesion, const Configuracion& config) {
+    if (config.puntoControl == nullptr) {
+        return true;
+    }
 
-    if (inicio[1] != ',') {
-        return nullptr;
+    long long longitudValida = 0;
+    if (config.reanudar) {
+        EstadoControl estado;
+        ResultadoControl resultado = cargarPuntoControl(config.puntoControl, sesion.listaCarga,
+                                                        sesion.rotor, estado);
+        if (resultado == CONTROL_INCOMPATIBLE) {
+            // Empezar de cero vaciaría el archivo: mejor no tocarlo
+            printf("ERROR: %s se guardó con otro alfabeto o cableado del rotor; "
+                   "no se puede reanudar\n", config.puntoControl);
+            return false;
+        }
+        if (resultado == CONTROL_CARGADO) {
+            sesion.tramasRecibidas = estado.tramasRecibidas;
+            sesion.tramasInvalidas = estado.tramasInvalidas;
+            longitudValida = estado.bytesValidos;
+            printf("Reanudando desde %s: %lld tramas, %lld caracteres, rotor en '%c'\n\n",
+                   config.puntoControl, estado.tramasRecibidas, estado.caracteres,
+                   sesion.rotor.getCabeza());
+        } else {
+            printf("No hay instantáneas válidas en %s; se empieza desde cero\n\n",
+                   config.puntoControl);
+        }
+    }
+
+    sesion.control = new PuntoControl();
+    if (!sesion.control->abrir(config.puntoControl, sesion.listaCarga, longitudValida)) {
+        printf("ERROR: No se pudo abrir el punto de control %s\n", config.puntoControl);
+        return false;
+    }
+
+    sesion.intervaloControl = config.intervaloControl;
+    sesion.proximoControl = sesion.tramasRecibidas + sesion.tramasInvalidas + config.intervaloControl;
+    return true;
+}
+
+/**
+ * @brief Guarda una instantánea si ya se procesaron suficientes tramas
+ * @param sesion Flujo decodificado
+ * @param final true al terminar la sesión: guarda siempre y hace fsync
+ */
+void revisarPuntoControl(SesionPRT7& sesion, bool final) {
+    if (sesion.control == nullptr) return;
+
+    long long procesadas = sesion.tramasRecibidas + sesion.tramasInvalidas;
+    if (!final && procesadas < sesion.proximoControl) return;
+
+    if (!sesion.control->guardar(sesion.listaCarga, sesion.rotor,
+                                 sesion.tramasRecibidas, sesion.tramasInvalidas)) {
+        fprintf(stderr, "ERROR: No se pudo escribir el punto de control\n");
+    }
+    if (final) {
+        sesion.control->sincronizar();
+    }
+    sesion.proximoControl = procesadas + sesion.intervaloControl;
+}
+
+/**
+ * @brief Muestra los caracteres decodificados desde el último volcado
+ * @param sesion Flujo decodificado
+ * @param nivel Nivel de detalle (sólo LOG_NORMAL muestra el mensaje en curso)
+ * @details Con varios flujos los fragmentos se mezclarían en la consola, así
+ *          que cada mensaje se muestra entero en anunciarFinFlujo
+ */
+void volcarNuevos(SesionPRT7& sesion, NivelLog nivel) {
+    if (nivel == LOG_NORMAL && sesion.nombre == nullptr &&
+        sesion.listaCarga.getPendientes() > 0) {
+        sesion.listaCarga.imprimirNuevos(sesion.salida);
+        sesion.salida.vaciar();
+        fflush(stdout);
+    }
+}
+
+/**
+ * @brief Antepone el nombre del flujo al eco cuando se decodifican varios
+ * @param sesion Flujo decodificado (sin nombre en modo de un solo flujo)
+ */
+void imprimirOrigen(const SesionPRT7& sesion) {
+    if (sesion.nombre != nullptr) {
+        printf("[%s] ", sesion.nombre);
+    }
+}
+
+/**
+ * @brief Muestra el eco de una trama LOAD ya decodificada
+ * @param sesion Flujo decodificado
+ * @param caracter Carácter recibido en la trama
+ * @details Sólo imprime lo agregado desde el eco anterior, no la lista completa
+ */
+void imprimirEcoLoad(SesionPRT7& sesion, char caracter) {
+    printf("-> Fragmento '%c' procesado. Mensaje: +", caracter);
+    sesion.listaCarga.imprimirNuevos(sesion.salida);
+    sesion.salida.vaciar();
+    printf(" (%zu caracteres)\n", sesion.listaCarga.getTamano());
+}
+
+/**
+ * @brief Agrega una entrada al registro NDJSON de tramas
+ * @param sesion Flujo que recibió la trama
+ * @param trama Trama o marca de control recibida
+ * @details Cada línea lleva el número de secuencia y, según el tipo, el
+ *          carácter recibido y el decodificado, la rotación y la cabeza
+ *          resultante, o el motivo del rechazo
+ */
+void registrarTrama(SesionPRT7& sesion, const TramaCompacta& trama) {
+    EscritorSalida* r = sesion.registro;
+    if (r == nullptr) return;
+
+    r->escribirFormato("{\"seq\":%lld,", sesion.secuencia++);
+    if (sesion.nombre != nullptr) {
+        r->escribirCadena("\"origen\":\"");
+        r->escribirJSON(sesion.nombre, strlen(sesion.nombre));
+        r->escribirCadena("\",");
+    }
+
+    switch (trama.tipo) {
+    case TRAMA_LOAD: {
+        char recibido = (char)trama.valor;
+        char decodificado = sesion.listaCarga.fin().valor();
+        r->escribirCadena("\"tipo\":\"L\",\"valor\":\"");
+        r->escribirJSON(&recibido, 1);
+        r->escribirCadena("\",\"decodificado\":\"");
+        r->escribirJSON(&decodificado, 1);
+        r->escribirCadena("\"}\n");
+        break;
+    }
+    case TRAMA_MAP: {
+        char cabeza = sesion.rotor.getCabeza();
+        r->escribirFormato("\"tipo\":\"M\",\"rotacion\":%d,\"cabeza\":\"", trama.valor);
+        r->escribirJSON(&cabeza, 1);
+        r->escribirCadena("\"}\n");
+        break;
+    }
+    case TRAMA_INVALIDA:
+        r->escribirFormato("\"tipo\":\"X\",\"error\":\"%s\"}\n",
+                           descripcionErrorTrama((ErrorTrama)trama.valor));
+        break;
+    default:
+        r->escribirFormato("\"tipo\":\"%c\"}\n", trama.tipo);
+        break;
+    }
+}
+
+/**
+ * @brief Procesa una línea recibida del puerto serial o de una captura
+ * @param sesion Estado de decodificación del flujo
+ * @param linea Línea sin salto de línea final (no necesita terminar en '\0')
+ * @param longitud Número de caracteres de la línea
+ * @param nivel Nivel de detalle de la salida
+ * @return true si la línea marca el fin de la transmisión
+ */
+bool procesarLinea(SesionPRT7& sesion, const char* linea, int longitud, NivelLog nivel) {
+    const bool detallado = nivel == LOG_DETALLADO;
+
+    // Verificar mensajes especiales
+    if (contieneMarca(linea, longitud, MARCA_INICIO_PRT7)) {
+        registrarTrama(sesion, crearTramaControl(TRAMA_INICIO));
+        if (nivel >= LOG_NORMAL) printf(">>> Inicio de transmisión detectado <<<\n\n");
+        return false;
+    }
+
+    if (contieneMarca(linea, longitud, MARCA_FIN_PRT7)) {
+        registrarTrama(sesion, crearTramaControl(TRAMA_FIN));
+        volcarNuevos(sesion, nivel);
+        if (nivel >= LOG_NORMAL) printf("\n>>> Fin de transmisión detectado <<<\n");
+        return true;
+    }
+
+    // Ignorar líneas vacías
+    if (longitud == 0 || linea[0] == '\r' || linea[0] == '\n') {
+        return false;
+    }
+
+    // Cronometrar sólo una muestra: leer el reloj cuesta más que el parseo
+    MetricasPRT7& metricas = *sesion.metricas;
+    const bool muestrear = (sesion.tramasRecibidas + sesion.tramasInvalidas) % MUESTREO_LATENCIA == 0;
+    unsigned long long t0 = muestrear ? relojNs() : 0;
+
+    // Parsear la trama (reservada en la arena, sin new/delete)
+    ErrorTrama error;
+    TramaBase* trama = parsearTrama(linea, longitud, sesion.arena, &error);
+
+    unsigned long long t1 = muestrear ? relojNs() : 0;
+    if (muestrear) metricas.latenciaParseo.registrar(t1 - t0);
+
+    if (trama != nullptr) {
+        sesion.tramasRecibidas++;
+
+        // Procesar la trama (polimorfismo en acción)
+        trama->procesar(&sesion.listaCarga, &sesion.rotor);
+        if (muestrear) metricas.latenciaDecodificacion.registrar(relojNs() - t1);
+
+        TramaLoad* load = dynamic_cast<TramaLoad*>(trama);
+        sumarContador(load != nullptr ? metricas.tramasLoad : metricas.tramasMap, 1);
+
+        if (sesion.registro != nullptr) {
+            registrarTrama(sesion, load != nullptr
+                                   ? crearTramaLoad(load->getCaracter())
+                                   : crearTramaMap(static_cast<TramaMap*>(trama)->getRotacion()));
+        }
+
+        if (detallado) {
+            char texto[20];
+            trama->toString(texto, sizeof(texto));
+            printf("Trama recibida: [%s] -> Procesando... ", texto);
+
+            // Mostrar resultado según el tipo
+            TramaMap* map = dynamic_cast<TramaMap*>(trama);
+
+            if (load != nullptr) {
+                imprimirEcoLoad(sesion, load->getCaracter());
+            } else if (map != nullptr) {
+                printf("-> ROTANDO ROTOR %+d. (Cabeza ahora en '%c')\n",
+                       map->getRotacion(), sesion.rotor.getCabeza());
+            }
+        }
+
+        // Descartar la trama: la arena se reutiliza en la siguiente
+        sesion.arena.reiniciar();
+
+    } else {
+        // Trama mal formada
+        sesion.tramasInvalidas++;
+        sumarContador(metricas.tramasInvalidas, 1);
+        registrarTrama(sesion, crearTramaControl(TRAMA_INVALIDA, error));
+        if (detallado) {
+            printf("Trama inválida recibida: [%.*s] (%s)\n", longitud, linea,
+                   descripcionErrorTrama(error));
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Procesa una trama compacta entregada por el hilo lector
+ * @param sesion Estado de decodificación del flujo
+ * @param trama Trama o marca de control
+ * @param nivel Nivel de detalle de la salida
+ * @return true si la trama marca el fin de la transmisión
+ */
+bool procesarTramaCompacta(SesionPRT7& sesion, const TramaCompacta& trama, NivelLog nivel) {
+    const bool detallado = nivel == LOG_DETALLADO;
+
+    // Las marcas y las tramas rechazadas se registran antes de procesarse
+    if (trama.tipo != TRAMA_LOAD && trama.tipo != TRAMA_MAP) {
+        registrarTrama(sesion, trama);
+    }
+
+    switch (trama.tipo) {
+    case TRAMA_INICIO:
+        if (nivel >= LOG_NORMAL) {
+            imprimirOrigen(sesion);
+            printf(">>> Inicio de transmisión detectado <<<\n\n");
+        }
+        return false;
+
+    case TRAMA_FIN:
+        volcarNuevos(sesion, nivel);
+        if (nivel >= LOG_NORMAL) {
+            // Cierra la línea del mensaje en curso (sólo la hay con un flujo)
+            if (sesion.nombre == nullptr) printf("\n");
+            imprimirOrigen(sesion);
+            printf(">>> Fin de transmisión detectado <<<\n");
+        }
+        return true;
+
+    case TRAMA_INVALIDA:
+        sesion.tramasInvalidas++;
+        sumarContador(sesion.metricas->tramasInvalidas, 1);
+        if (detallado) {
+            imprimirOrigen(sesion);
+            printf("Trama inválida recibida (%s)\n",
+                   descripcionErrorTrama((ErrorTrama)trama.valor));
+        }
+        return false;
+
+    case TRAMA_LOAD: {
+        char caracter = (char)trama.valor;
+        sesion.tramasRecibidas++;
+        sesion.listaCarga.insertarAlFinal(sesion.rotor.getMapeo(caracter));
+        sumarContador(sesion.metricas->tramasLoad, 1);
+        registrarTrama(sesion, trama);
+        if (detallado) {
+            imprimirOrigen(sesion);
+            printf("Trama recibida: [L,%c] -> Procesando... ", caracter);
+            imprimirEcoLoad(sesion, caracter);
+        }
+        return false;
+    }
+
+    case TRAMA_MAP:
+        sesion.tramasRecibidas++;
+        sesion.rotor.rotar(trama.valor);
+        sumarContador(sesion.metricas->tramasMap, 1);
+        registrarTrama(sesion, trama);
+        if (detallado) {
+            imprimirOrigen(sesion);
+            printf("Trama recibida: [M,%d] -> Procesando... ", trama.valor);
+            printf("-> ROTANDO ROTOR %+d. (Cabeza ahora en '%c')\n",
+                   trama.valor, sesion.rotor.getCabeza());
+        }
+        return false;
+
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Procesa un lote de tramas compactas en orden
+ * @param sesion Estado de decodificación del flujo
+ * @param tramas Tramas y marcas de control del lote
+ * @param n Número de tramas
+ * @param nivel Nivel de detalle de la salida
+ * @return true si el lote contiene el fin de la transmisión
+ * @details Las rachas de tramas LOAD/MAP entre dos marcas se decodifican de
+ *          una vez con decodificarLoteParalelo (que usa decodificarLote si
+ *          la racha es corta o la sesión tiene un solo hilo). El eco por trama y el registro
+ *          NDJSON necesitan el estado tras cada trama, así que con ellos
+ *          se procesa trama a trama.
+ */
+bool procesarLoteTramas(SesionPRT7& sesion, const TramaCompacta* tramas, size_t n,
+                        NivelLog nivel) {
+    if (nivel == LOG_DETALLADO || sesion.registro != nullptr) {
+        for (size_t i = 0; i < n; i++) {
+            if (procesarTramaCompacta(sesion, tramas[i], nivel)) return true;
+        }
+        return false;
+    }
+
+    size_t i = 0;
+    while (i < n) {
+        size_t j = i;
+        while (j < n && (tramas[j].tipo == TRAMA_LOAD || tramas[j].tipo == TRAMA_MAP)) {
+            j++;
+        }
+
+        if (j > i) {
+            size_t loads = decodificarLoteParalelo(tramas + i, j - i, sesion.listaCarga,
+                                                   sesion.rotor, sesion.hilos);
+            sesion.tramasRecibidas += (long long)(j - i);
+            sumarContador(sesion.metricas->tramasLoad, loads);
+            sumarContador(sesion.metricas->tramasMap, (j - i) - loads);
+            i = j;
+        }
+
+        if (i < n && procesarTramaCompacta(sesion, tramas[i++], nivel)) {
+            return true;
+        }
     }
+    return false;
+}
+
+/**
+ * @struct ContextoLector
+ * @brief Datos compartidos con el hilo que lee el puerto serial
+ */
+struct ContextoLector {
+    SerialHandle puerto;      ///< Puerto a leer
+    int inactividadMs;        ///< Espera máxima de poll() sin datos
+    ColaTramasSPSC* cola;     ///< Cola hacia el decodificador
+    MetricasPRT7* metricas;   ///< Bytes, espera y parseo los escribe sólo este hilo
+    bool error;               ///< Se perdió la conexión (leer tras join)
+    unsigned long long esperasColaLlena; ///< Vueltas esperando espacio en la cola
+};
+
+/**
+ * @brief Hilo productor: lee lotes de tramas ya analizadas y los encola
+ * @param ctx Contexto del lector
+ * @details Termina al encolar FIN_TRANSMISION_PRT7 o al perder el puerto;
+ *          en ambos casos cierra la cola. Si la cola está llena cede el
+ *          procesador hasta que el decodificador libere espacio.
+ */
+void hiloLectorSerial(ContextoLector* ctx) {
+    LectorSerial lector;
+    inicializarLectorSerial(lector, ctx->puerto);
+
+    TramaCompacta pendientes[MAX_TRAMAS_LOTE];
+    bool fin = false;
+
+    while (!fin) {
+        // El lote se cronometra entero (lectura no bloqueante y análisis)
+        unsigned long long t0 = relojNs();
+        int n = leerTramas(lector, pendientes, MAX_TRAMAS_LOTE);
+        unsigned long long duracion = relojNs() - t0;
+
+        if (n < 0) {
+            ctx->error = true;
+            break;
+        }
+
+        ctx->metricas->bytesLeidos.store(lector.bytesLeidos, std::memory_order_relaxed);
+        ctx->metricas->lecturas.store(lector.lecturas, std::memory_order_relaxed);
+
+        // Sin líneas completas: bloquear hasta que lleguen más bytes
+        if (n == 0) {
+            t0 = relojNs();
+            int r = esperarDatosSerial(ctx->puerto, ctx->inactividadMs);
+            unsigned long long espera = relojNs() - t0;
+            sumarContador(ctx->metricas->esperaSerialNs, espera);
+            ctx->metricas->esperaSerial.registrar(espera);
+
+            if (r < 0) {
+                ctx->error = true;
+                break;
+            }
+            continue;
+        }
 
-    if (tipo == 'L') {
-        // Trama LOAD: L,X
-        char caracter = inicio[2];
-        return new TramaLoad(caracter);
+        // leerTramas corta el lote en la marca de fin
+        size_t k = (size_t)n;
+        fin = pendientes[k - 1].tipo == TRAMA_FIN;
+        ctx->metricas->latenciaParseo.registrar(duracion / k, k);
 
-    } else if (tipo == 'M') {
-        // Trama MAP: M,N
-        int rotacion = atoi(&inicio[2]);
-        return new TramaMap(rotacion);
+        size_t enviadas = ctx->cola->insertar(pendientes, k);
+        while (enviadas < k) {
+            ctx->esperasColaLlena++;
+            std::this_thread::yield();
+            enviadas += ctx->cola->insertar(pendientes + enviadas, k - enviadas);
+        }
     }
 
-    return nullptr;
+    ctx->cola->cerrar();
 }
 
 /**
@@ -115,23 +841,66 @@ void solicitarPuerto(char* buffer, int bufferSize) {
 }
 
 /**
- * @brief Función principal del decodificador
- * @return 0 si todo fue exitoso
+ * @brief Imprime el resumen final y el mensaje ensamblado
+ * @param sesion Flujo decodificado
+ * @param config Formato del mensaje y ventana opcional a mostrar
  */
-int main() {
-    imprimirBanner();
+void imprimirResultado(SesionPRT7& sesion, const Configuracion& config) {
+    FormatoSalida formato = config.formato;
+    printf("\n");
+    printf("========================================\n");
+    printf("   DECODIFICACIÓN COMPLETADA\n");
+    printf("========================================\n");
+    if (sesion.nombre != nullptr) {
+        printf("Origen: %s\n", sesion.nombre);
+    }
+    printf("Tramas procesadas: %lld\n", sesion.tramasRecibidas);
+    printf("Caracteres decodificados: %zu\n\n", sesion.listaCarga.getTamano());
+
+    printf("MENSAJE OCULTO ENSAMBLADO:\n");
+    if (formato == SALIDA_NDJSON) {
+        sesion.listaCarga.volcar(sesion.salida, formato);
+        sesion.salida.vaciar();
+    } else {
+        printf(">>> ");
+        sesion.listaCarga.volcar(sesion.salida, formato);
+        sesion.salida.vaciar();
+        printf(" <<<\n");
+    }
+
+    // La ventana se toma del directorio de bloques, sin recorrer el mensaje
+    if (config.ventanaDesde >= 0) {
+        printf("VENTANA [%lld, +%lld):\n>>> ", config.ventanaDesde, config.ventanaCantidad);
+        sesion.listaCarga.escribirRango((size_t)config.ventanaDesde, (size_t)config.ventanaCantidad,
+                                        sesion.salida);
+        sesion.salida.vaciar();
+        printf(" <<<\n");
+    }
+    printf("========================================\n\n");
+}
 
-    // Solicitar puerto al usuario
-    char nombrePuerto[50];
-    solicitarPuerto(nombrePuerto, sizeof(nombrePuerto));
+/**
+ * @brief Decodifica una transmisión en vivo desde el puerto serial
+ * @param config Configuración de ejecución
+ * @param inst Registro y métricas de la ejecución
+ * @return Código de salida del programa
+ */
+int ejecutarSerial(const Configuracion& config, Instrumentacion& inst) {
+    // Solicitar puerto al usuario si no se indicó
+    char nombrePuerto[256];
+    if (config.numPuertos > 0) {
+        snprintf(nombrePuerto, sizeof(nombrePuerto), "%s", config.puertos[0]);
+    } else {
+        solicitarPuerto(nombrePuerto, sizeof(nombrePuerto));
+    }
 
     printf("\nIniciando Decodificador PRT-7...\n");
-    printf("Conectando a puerto %s...\n", nombrePuerto);
+    printf("Conectando a puerto %s a %d baudios...\n", nombrePuerto, config.baudios);
 
     // Abrir puerto serial
-    SerialHandle puerto = abrirPuertoSerial(nombrePuerto, 9600);
+    SerialHandle puerto = abrirPuertoSerial(nombrePuerto, config.baudios);
     if (puerto == INVALID_SERIAL_HANDLE) {
-        printf("ERROR: No se pudo abrir el puerto serial.\n");
+        printf("ERROR: No se pudo abrir el puerto serial (%s).\n", ultimoErrorSerial());
         printf("Verifique que:\n");
         printf("  1. El Arduino está conectado\n");
         printf("  2. El puerto es correcto\n");
@@ -145,88 +914,458 @@ int main() {
     SLEEP_MS(2000);
 
     // Crear las estructuras de datos
-    ListaDeCarga listaCarga;
-    RotorDeMapeo rotor;
+    SesionPRT7* sesion = new SesionPRT7;
+    sesion->puerto = puerto;
+    sesion->instrumentar(inst);
+    sesion->cablearRotor(config);
+    if (!prepararPuntoControl(*sesion, config)) {
+        cerrarPuertoSerial(puerto);
+        delete sesion;
+        return 1;
+    }
 
-    // Buffer para leer líneas
-    char linea[256];
-    int tramasRecibidas = 0;
-    bool finTransmision = false;
+    // Hilo lector: la E/S no espera a la decodificación ni a printf
+    ColaTramasSPSC cola(CAPACIDAD_COLA_TRAMAS);
+    ContextoLector contexto;
+    contexto.puerto = puerto;
+    contexto.inactividadMs = config.inactividadMs;
+    contexto.cola = &cola;
+    contexto.metricas = &inst.metricas;
+    contexto.error = false;
+    contexto.esperasColaLlena = 0;
+    std::thread lector(hiloLectorSerial, &contexto);
 
-    // Bucle principal de procesamiento
-    while (!finTransmision) {
-        if (leerLineaSerial(puerto, linea, sizeof(linea))) {
+    TramaCompacta recibidas[MAX_TRAMAS_CONSUMO];
 
-            // Verificar mensajes especiales
-            if (strstr(linea, "INICIO_TRANSMISION_PRT7") != nullptr) {
-                printf(">>> Inicio de transmisión detectado <<<\n\n");
-                continue;
+    // Bucle del decodificador: consumir la cola hasta el fin de transmisión
+    while (!sesion->terminada) {
+        // Leer el cierre antes de extraer: si estaba cerrada y no hay nada, terminó
+        bool cerrada = cola.estaCerrada();
+        size_t n = cola.extraer(recibidas, MAX_TRAMAS_CONSUMO);
+
+        if (n > 0) {
+            unsigned long long t0 = relojNs();
+            sesion->terminada = procesarLoteTramas(*sesion, recibidas, n, config.nivel);
+            volcarNuevos(*sesion, config.nivel);
+            inst.metricas.latenciaDecodificacion.registrar((relojNs() - t0) / n, n);
+            revisarPuntoControl(*sesion, false);
+        }
+        revisarMetricas(inst);
+
+        if (n == 0) {
+            if (cerrada) break;
+            cola.esperarDatos(ESPERA_COLA_MS);
+        }
+    }
+
+    lector.join();
+
+    if (contexto.error) {
+        printf("ERROR: Se perdió la conexión con el puerto serial.\n");
+    }
+
+    revisarPuntoControl(*sesion, true);
+    imprimirResultado(*sesion, config);
+    printf("Cola lector/decodificador: capacidad %zu, nivel máximo %zu, "
+           "inserciones rechazadas %llu, esperas del lector %llu\n",
+           cola.getCapacidad(), cola.getMaximoOcupado(),
+           cola.getRechazos(), contexto.esperasColaLlena);
+
+    // Cerrar puerto
+    cerrarPuertoSerial(puerto);
+    delete sesion;
+    printf("Liberando memoria... Sistema apagado.\n\n");
+
+    return 0;
+}
+
+/**
+ * @brief Muestra el mensaje de un flujo que terminó en modo multiflujo
+ * @param sesion Flujo terminado
+ */
+void anunciarFinFlujo(SesionPRT7& sesion) {
+    printf("[%s] Fin de transmisión: %lld tramas, %zu caracteres: ",
+           sesion.nombre, sesion.tramasRecibidas, sesion.listaCarga.getTamano());
+    sesion.listaCarga.volcar(sesion.salida, SALIDA_CRUDA);
+    sesion.salida.vaciar();
+    printf("\n");
+}
+
+/**
+ * @brief Decodifica varios flujos a la vez con un solo bucle de eventos
+ * @param config Configuración de ejecución (varios puertos, o puertos y
+ *               una captura)
+ * @param inst Registro y métricas compartidos por todos los flujos
+ * @return Código de salida del programa
+ * @details Cada flujo tiene su propia sesión (lista, rotor, arena y
+ *          lector). Un único esperarDatosSeriales bloquea hasta que algún
+ *          puerto tenga datos y sólo se leen los puertos listos. Una
+ *          captura siempre está lista: en cada vuelta se procesan
+ *          TAM_TRAMO_MULTIFLUJO bytes de ella y, mientras le queden datos,
+ *          la espera sobre los puertos no bloquea. Las capturas binarias se
+ *          decodifican de una vez al abrirlas. Cada sesión termina por
+ *          separado al recibir FIN_TRANSMISION_PRT7 (la captura también al
+ *          acabarse). El eco de --nivel detallado y las marcas llevan el
+ *          nombre del flujo delante.
+ */
+int ejecutarMultipuerto(const Configuracion& config, Instrumentacion& inst) {
+    const int n = config.numPuertos;
+    const bool conCaptura = config.captura != nullptr;
+    SesionPRT7* sesiones = new SesionPRT7[n + (conCaptura ? 1 : 0)];
+    SerialHandle handles[MAX_PUERTOS];
+    bool listos[MAX_PUERTOS];
+    bool fallidos[MAX_PUERTOS];
+
+    // En la primera vuelta se intenta leer de todos los puertos
+    for (int i = 0; i < n; i++) {
+        listos[i] = true;
+        fallidos[i] = false;
+    }
+    int activas = 0;
+
+    printf("\nIniciando Decodificador PRT-7 en %d flujos...\n", n + (conCaptura ? 1 : 0));
+
+    for (int i = 0; i < n; i++) {
+        sesiones[i].nombre = config.puertos[i];
+        sesiones[i].instrumentar(inst);
+        sesiones[i].cablearRotor(config);
+        sesiones[i].puerto = abrirPuertoSerial(config.puertos[i], config.baudios);
+        handles[i] = sesiones[i].puerto;
+
+        if (sesiones[i].puerto == INVALID_SERIAL_HANDLE) {
+            printf("ERROR: No se pudo abrir el puerto %s (%s)\n", config.puertos[i],
+                   ultimoErrorSerial());
+            sesiones[i].terminada = true;
+            continue;
+        }
+
+        inicializarLectorSerial(sesiones[i].lector, sesiones[i].puerto);
+        printf("  [%s] conectado\n", config.puertos[i]);
+        activas++;
+    }
+
+    // La captura es la sesión n; no tiene handle en la espera
+    CapturaPRT7 captura;
+    captura.datos = nullptr;
+    captura.tamano = 0;
+    captura.proyectada = false;
+    captura.recurso = nullptr;
+    size_t posicionCaptura = 0;
+    SesionPRT7* archivo = nullptr;
+
+    if (conCaptura) {
+        archivo = &sesiones[n];
+        archivo->nombre = strcmp(config.captura, "-") == 0 ? "stdin" : config.captura;
+        archivo->instrumentar(inst);
+        archivo->cablearRotor(config);
+
+        if (!abrirCaptura(config.captura, captura)) {
+            printf("ERROR: No se pudo abrir la captura %s\n", archivo->nombre);
+            archivo->terminada = true;
+        } else if (esCapturaBinaria(captura.datos, captura.tamano)) {
+            unsigned long long tramas = 0;
+            if (!decodificarCapturaBinaria(captura.datos, captura.tamano, archivo->listaCarga,
+                                           archivo->rotor, tramas, config.hilos)) {
+                printf("ERROR: Captura binaria corrupta o de versión no soportada\n");
             }
+            archivo->tramasRecibidas = (long long)tramas;
+            archivo->terminada = true;
+            sumarContador(inst.metricas.bytesLeidos, captura.tamano);
+            anunciarFinFlujo(*archivo);
+        } else {
+            printf("  [%s] captura abierta\n", archivo->nombre);
+            activas++;
+        }
+    }
 
-            if (strstr(linea, "FIN_TRANSMISION_PRT7") != nullptr) {
-                printf("\n>>> Fin de transmisión detectado <<<\n");
-                finTransmision = true;
-                break;
+    printf("Esperando tramas...\n\n");
+
+    TramaCompacta lote[MAX_TRAMAS_LOTE];
+
+    while (activas > 0) {
+        // Vaciar cada puerto listo antes de volver a esperar
+        for (int i = 0; i < n; i++) {
+            SesionPRT7& sesion = sesiones[i];
+            if (sesion.terminada || (!listos[i] && !fallidos[i])) continue;
+
+            unsigned long long bytesAntes = sesion.lector.bytesLeidos;
+            unsigned long long lecturasAntes = sesion.lector.lecturas;
+
+            // Un puerto que colgó sin datos pendientes no se vuelve a leer
+            int leidas = -1;
+            unsigned long long t0 = relojNs();
+            while (!fallidos[i] && (leidas = leerTramas(sesion.lector, lote, MAX_TRAMAS_LOTE)) > 0) {
+                unsigned long long t1 = relojNs();
+                inst.metricas.latenciaParseo.registrar((t1 - t0) / leidas, leidas);
+
+                sesion.terminada = procesarLoteTramas(sesion, lote, leidas, config.nivel);
+                t0 = relojNs();
+                inst.metricas.latenciaDecodificacion.registrar((t0 - t1) / leidas, leidas);
+                if (sesion.terminada) break;
             }
 
-            // Ignorar líneas vacías
-            if (linea[0] == '\0' || linea[0] == '\r' || linea[0] == '\n') {
-                continue;
+            sumarContador(inst.metricas.bytesLeidos, sesion.lector.bytesLeidos - bytesAntes);
+            sumarContador(inst.metricas.lecturas, sesion.lector.lecturas - lecturasAntes);
+
+            if (leidas < 0) {
+                printf("ERROR: [%s] se perdió la conexión\n", sesion.nombre);
+                sesion.terminada = true;
             }
 
-            // Parsear la trama
-            TramaBase* trama = parsearTrama(linea);
+            if (sesion.terminada) {
+                anunciarFinFlujo(sesion);
 
-            if (trama != nullptr) {
-                tramasRecibidas++;
+                cerrarPuertoSerial(sesion.puerto);
+                sesion.puerto = INVALID_SERIAL_HANDLE;
+                handles[i] = INVALID_SERIAL_HANDLE;
+                activas--;
+            }
+        }
 
-                printf("Trama recibida: [%s] -> Procesando... ", trama->toString());
+        // La captura avanza un tramo por vuelta para no retrasar a los puertos
+        if (archivo != nullptr && !archivo->terminada) {
+            size_t antes = posicionCaptura;
+            unsigned long long t0 = relojNs();
+            size_t leidas = clasificarTramoCaptura(captura, posicionCaptura,
+                                                   TAM_TRAMO_MULTIFLUJO, lote, 1);
+            unsigned long long t1 = relojNs();
+            sumarContador(inst.metricas.bytesLeidos, posicionCaptura - antes);
 
-                // Procesar la trama (polimorfismo en acción)
-                trama->procesar(&listaCarga, &rotor);
+            if (leidas > 0) {
+                inst.metricas.latenciaParseo.registrar((t1 - t0) / leidas, leidas);
+                archivo->terminada = procesarLoteTramas(*archivo, lote, leidas, config.nivel);
+                inst.metricas.latenciaDecodificacion.registrar((relojNs() - t1) / leidas, leidas);
+            }
 
-                // Mostrar resultado según el tipo
-                TramaLoad* load = dynamic_cast<TramaLoad*>(trama);
-                TramaMap* map = dynamic_cast<TramaMap*>(trama);
+            if (archivo->terminada || posicionCaptura >= captura.tamano) {
+                archivo->terminada = true;
+                anunciarFinFlujo(*archivo);
+                activas--;
+            }
+        }
 
-                if (load != nullptr) {
-                    printf("-> Fragmento '%c' procesado. ", load->getCaracter());
-                    listaCarga.imprimirConFormato();
-                } else if (map != nullptr) {
-                    printf("-> ROTANDO ROTOR %+d. (Cabeza ahora en '%c')\n",
-                           map->getRotacion(), rotor.getCabeza());
-                }
+        if (activas == 0) break;
+        revisarMetricas(inst);
 
-                // Liberar memoria de la trama
-                delete trama;
+        unsigned long long t0 = relojNs();
+        int espera = archivo != nullptr && !archivo->terminada ? 0 : config.inactividadMs;
+        int r = esperarDatosSeriales(handles, n, listos, fallidos, espera);
+        unsigned long long esperaNs = relojNs() - t0;
+        sumarContador(inst.metricas.esperaSerialNs, esperaNs);
+        inst.metricas.esperaSerial.registrar(esperaNs);
 
-            } else {
-                // Trama mal formada
-                printf("Trama inválida recibida: [%s]\n", linea);
-            }
+        if (r < 0) {
+            printf("ERROR: Falló la espera sobre los puertos\n");
+            break;
         }
+    }
 
-        // Pequeña pausa para no saturar el CPU
-        SLEEP_MS(50);
+    for (int i = 0; i < n; i++) {
+        imprimirResultado(sesiones[i], config);
+        cerrarPuertoSerial(sesiones[i].puerto);
+    }
+    if (archivo != nullptr) {
+        imprimirResultado(*archivo, config);
     }
+    cerrarCaptura(captura);
 
-    // Mostrar resultado final
-    printf("\n");
-    printf("========================================\n");
-    printf("   DECODIFICACIÓN COMPLETADA\n");
-    printf("========================================\n");
-    printf("Tramas procesadas: %d\n", tramasRecibidas);
-    printf("Caracteres decodificados: %d\n\n", listaCarga.getTamano());
+    delete[] sesiones;
+    printf("Liberando memoria... Sistema apagado.\n\n");
 
-    printf("MENSAJE OCULTO ENSAMBLADO:\n");
-    printf(">>> ");
-    listaCarga.imprimirMensaje();
-    printf(" <<<\n");
-    printf("========================================\n\n");
+    return 0;
+}
 
-    // Cerrar puerto
-    cerrarPuertoSerial(puerto);
+/**
+ * @brief Decodifica una captura grabada en archivo o recibida por stdin
+ * @param config Configuración de ejecución
+ * @param inst Registro y métricas de la ejecución
+ * @return Código de salida del programa
+ * @details Las líneas de las capturas de texto se recorren sobre la
+ *          proyección del archivo sin copiarlas. Si no hace falta el estado
+ *          tras cada trama (eco detallado o registro NDJSON), la captura se
+ *          analiza por ventanas y cada ventana se decodifica en lote, ambas
+ *          cosas repartidas entre config.hilos hilos; si no, cada línea
+ *          pasa por el mismo flujo que el modo serial (TramaBase,
+ *          ListaDeCarga, RotorDeMapeo). Las capturas en formato binario
+ *          (ver FormatoBinario.h) se decodifican por rachas.
+ */
+int ejecutarReplay(const Configuracion& config, Instrumentacion& inst) {
+    const char* nombre = strcmp(config.captura, "-") == 0 ? "stdin" : config.captura;
+    printf("Reproduciendo captura %s...\n\n", nombre);
+
+    CapturaPRT7 captura;
+    if (!abrirCaptura(config.captura, captura)) {
+        printf("ERROR: No se pudo abrir la captura %s\n", nombre);
+        return 1;
+    }
+
+    SesionPRT7* sesion = new SesionPRT7;
+    sesion->instrumentar(inst);
+    sesion->cablearRotor(config);
+    sesion->hilos = config.hilos;
+
+    bool binaria = esCapturaBinaria(captura.datos, captura.tamano);
+    if (binaria && config.puntoControl != nullptr) {
+        printf("AVISO: El punto de control no se usa con capturas binarias\n\n");
+    } else if (!prepararPuntoControl(*sesion, config)) {
+        delete sesion;
+        cerrarCaptura(captura);
+        return 1;
+    }
+
+    if (binaria) {
+        // Formato binario: sin parseo por trama
+        // (sin desglose LOAD/MAP: las rachas se decodifican en bloque)
+        unsigned long long tramas = 0;
+        unsigned long long t0 = relojNs();
+        if (!decodificarCapturaBinaria(captura.datos, captura.tamano,
+                                       sesion->listaCarga, sesion->rotor, tramas,
+                                       config.hilos)) {
+            printf("ERROR: Captura binaria corrupta o de versión no soportada\n");
+        }
+        if (tramas > 0) {
+            inst.metricas.latenciaDecodificacion.registrar((relojNs() - t0) / tramas, tramas);
+        }
+        sesion->tramasRecibidas = (long long)tramas;
+        sumarContador(inst.metricas.bytesLeidos, captura.tamano);
+    } else {
+        size_t posicion = 0;
+        const char* linea;
+        size_t longitud;
+        unsigned int lineas = 0;
+
+        // Al reanudar, saltar las tramas que ya cubre la instantánea
+        long long saltar = sesion->tramasRecibidas + sesion->tramasInvalidas;
+        while (saltar > 0 && siguienteLineaCaptura(captura, posicion, linea, longitud)) {
+            TramaCompacta t;
+            if (clasificarLinea(linea, (int)longitud, t) &&
+                t.tipo != TRAMA_INICIO && t.tipo != TRAMA_FIN) {
+                saltar--;
+            }
+        }
+
+        if (config.nivel != LOG_DETALLADO && sesion->registro == nullptr) {
+            // Por ventanas: análisis y decodificación en lote
+            TramaCompacta* lote = new TramaCompacta[(TAM_VENTANA_CAPTURA + 1) / 2];
+            bool fin = false;
+
+            while (!fin && posicion < captura.tamano) {
+                unsigned long long t0 = relojNs();
+                size_t n = clasificarTramoCaptura(captura, posicion, TAM_VENTANA_CAPTURA,
+                                                  lote, config.hilos);
+                unsigned long long t1 = relojNs();
+                if (n > 0) inst.metricas.latenciaParseo.registrar((t1 - t0) / n, n);
+
+                // Con punto de control, el lote se corta donde toca cada instantánea
+                size_t i = 0;
+                while (!fin && i < n) {
+                    size_t trozo = n - i;
+                    if (sesion->control != nullptr) {
+                        long long faltan = sesion->proximoControl -
+                                           (sesion->tramasRecibidas + sesion->tramasInvalidas);
+                        if (faltan < 1) faltan = 1;
+                        if ((unsigned long long)faltan < trozo) trozo = (size_t)faltan;
+                    }
+                    fin = procesarLoteTramas(*sesion, lote + i, trozo, config.nivel);
+                    revisarPuntoControl(*sesion, false);
+                    i += trozo;
+                }
+                if (n > 0) inst.metricas.latenciaDecodificacion.registrar((relojNs() - t1) / n, n);
+
+                inst.metricas.bytesLeidos.store(posicion, std::memory_order_relaxed);
+                revisarMetricas(inst);
+            }
+
+            delete[] lote;
+        } else {
+            while (siguienteLineaCaptura(captura, posicion, linea, longitud)) {
+                if (procesarLinea(*sesion, linea, (int)longitud, config.nivel)) {
+                    break;
+                }
+                revisarPuntoControl(*sesion, false);
+                if (++lineas % 4096 == 0) {
+                    inst.metricas.bytesLeidos.store(posicion, std::memory_order_relaxed);
+                    revisarMetricas(inst);
+                }
+            }
+        }
+        inst.metricas.bytesLeidos.store(posicion, std::memory_order_relaxed);
+        volcarNuevos(*sesion, config.nivel);
+        revisarPuntoControl(*sesion, true);
+    }
+
+    imprimirResultado(*sesion, config);
+
+    delete sesion;
+    cerrarCaptura(captura);
     printf("Liberando memoria... Sistema apagado.\n\n");
 
     return 0;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Función principal del decodificador
+ * @param argc Número de argumentos
+ * @param argv Argumentos (ver imprimirUso)
+ * @return 0 si todo fue exitoso
+ */
+int main(int argc, char* argv[]) {
+    Configuracion config;
+    if (!leerArgumentos(argc, argv, config)) {
+        imprimirUso(argv[0]);
+        return 1;
+    }
+    if (config.ayuda) {
+        imprimirUso(argv[0]);
+        return 0;
+    }
+
+    imprimirBanner();
+
+    Instrumentacion* inst = new Instrumentacion;
+    inst->rutaMetricas = config.metricas;
+    inst->intervaloNs = (unsigned long long)config.estadisticasSeg * 1000000000ULL;
+    inst->proximaNs = relojNs() + inst->intervaloNs;
+    instalarSenalMetricas();
+
+    // Registro NDJSON opcional de todas las tramas recibidas
+    FILE* archivoRegistro = nullptr;
+    if (config.registro != nullptr) {
+        archivoRegistro = fopen(config.registro, "wb");
+        if (archivoRegistro == nullptr) {
+            printf("ERROR: No se pudo crear el registro %s\n", config.registro);
+            delete inst;
+            return 1;
+        }
+        inst->registro = new EscritorSalida(archivoRegistro);
+    }
+
+    int codigo;
+    if (config.captura != nullptr && config.numPuertos == 0) {
+        codigo = ejecutarReplay(config, *inst);
+    } else if (config.numPuertos > 1 || config.captura != nullptr) {
+        codigo = ejecutarMultipuerto(config, *inst);
+    } else {
+        codigo = ejecutarSerial(config, *inst);
+    }
+
+    if (inst->registro != nullptr) {
+        if (!inst->registro->vaciar()) {
+            printf("ERROR: No se pudo escribir el registro %s\n", config.registro);
+            codigo = 1;
+        }
+        delete inst->registro;
+        fclose(archivoRegistro);
+    }
+
+    if (config.estadisticasSeg > 0) {
+        imprimirLineaEstadisticas(inst->metricas, stderr);
+    }
+    if (config.metricas != nullptr && !guardarMetricas(inst->metricas, config.metricas)) {
+        printf("ERROR: No se pudieron guardar las métricas en %s\n", config.metricas);
+        codigo = 1;
+    }
+    delete inst;
+
+    return codigo;
+}